@@ -0,0 +1,393 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "counters.h"
+#include "eventsfile.h"
+#include "frametracker.h"
+#include "profiledmutex.h"
+#include "sinks/callbacksink.h"
+#include "uprofileimpl.h"
+#include "util/cpumonitor.h"
+#include "util/systemroot.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace uprofile;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+struct Options {
+    std::string output;   // stdout if empty
+    std::string filter;   // only run the benchmarks whose name contains it
+    std::string sysroot;  // procfs and sysfs root of the monitors, the running system if empty
+    int duration = 500;   // ms spent per benchmark
+};
+
+struct Result {
+    std::string name;
+    int threads;
+    unsigned long long iterations;
+    double elapsed; // ns
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+std::vector<Result> g_results;
+Options g_options;
+volatile unsigned long long g_sink; // keeps the measured calls from being optimized out
+
+bool selected(const std::string& name)
+{
+    return g_options.filter.empty() || name.find(g_options.filter) != std::string::npos;
+}
+
+unsigned long long elapsedSince(Clock::time_point begin)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+}
+
+void addResult(const Result& result)
+{
+    g_results.push_back(result);
+    std::cerr << result.name << " (" << result.threads << " thread(s)): "
+              << (result.iterations > 0 ? result.elapsed / result.iterations : 0.) << " ns/op" << std::endl;
+}
+
+// Call 'op' in batches until the benchmark duration (or 'maxIterations') is reached
+Result measure(const std::string& name, const std::function<void()>& op, unsigned long long maxIterations = 0)
+{
+    const unsigned long long batch = 16;
+    const unsigned long long duration = g_options.duration * 1000000ULL;
+    Result result = {name, 1, 0, 0., {}};
+    Clock::time_point begin = Clock::now();
+    do {
+        for (unsigned long long i = 0; i < batch; ++i) {
+            op();
+        }
+        result.iterations += batch;
+        result.elapsed = elapsedSince(begin);
+    } while (result.elapsed < duration && (maxIterations == 0 || result.iterations < maxIterations));
+    return result;
+}
+
+void benchTimestamps()
+{
+    const std::pair<const char*, TimestampUnit> units[] = {
+        {"timestamp/epoch_time", TimestampUnit::EPOCH_TIME},
+        {"timestamp/uptime", TimestampUnit::UPTIME}};
+    for (const auto& unit : units) {
+        if (!selected(unit.first)) {
+            continue;
+        }
+        UProfileImpl profiler;
+        profiler.setTimestampUnit(unit.second);
+        addResult(measure(unit.first, [&]() { g_sink = profiler.getTimestamp(); }));
+    }
+}
+
+// Latency of a timeBegin()/timeEnd() pair when called concurrently by several threads
+void benchSpans()
+{
+    const int threadCounts[] = {1, 2, 4, 8, 16, 32, 64};
+    for (int threadCount : threadCounts) {
+        std::string name = "time_begin_end/threads:" + std::to_string(threadCount);
+        if (!selected(name)) {
+            continue;
+        }
+
+        std::atomic<unsigned long long> events(0);
+        UProfileImpl profiler;
+        // The sink is owned by the profiler
+        profiler.addSink(new CallbackSink([&](const char*, size_t, size_t count) { events += count; }), {});
+        profiler.start(nullptr);
+
+        std::atomic<bool> running(true);
+        std::atomic<int> ready(0);
+        std::vector<unsigned long long> iterations(threadCount, 0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&, i]() {
+                const std::string title = "span_" + std::to_string(i);
+                ready++;
+                while (ready.load() < threadCount) {
+                }
+                unsigned long long count = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    for (int j = 0; j < 16; ++j) {
+                        profiler.timeBegin(title);
+                        profiler.timeEnd(title);
+                    }
+                    count += 16;
+                }
+                iterations[i] = count;
+            });
+        }
+        while (ready.load() < threadCount) {
+            std::this_thread::yield();
+        }
+        Clock::time_point begin = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(g_options.duration));
+        running = false;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double elapsed = elapsedSince(begin);
+        profiler.stop();
+
+        Result result = {name, threadCount, 0, 0., {}};
+        for (unsigned long long count : iterations) {
+            result.iterations += count;
+        }
+        // Time per pair as seen by each thread
+        result.elapsed = elapsed * threadCount;
+        result.extra.emplace_back("pairs_per_s", result.iterations * 1e9 / elapsed);
+        addResult(result);
+    }
+}
+
+void removeDirectory(const std::string& path)
+{
+    DIR* dir = opendir(path.c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                std::string child = path + "/" + entry->d_name;
+                if (unlink(child.c_str()) != 0) {
+                    removeDirectory(child);
+                }
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(path.c_str());
+}
+
+// Parsing of /proc/stat for large CPU counts, from a synthetic system root
+void benchCpuMonitor()
+{
+    const int cpuCounts[] = {64, 512, 4096};
+    for (int cpuCount : cpuCounts) {
+        std::string name = "cpu_monitor/cpus:" + std::to_string(cpuCount);
+        if (!selected(name)) {
+            continue;
+        }
+        char dirTemplate[] = "/tmp/uprof-benchmark-XXXXXX";
+        if (!mkdtemp(dirTemplate)) {
+            std::cerr << "Cannot create a temporary directory, skipping " << name << std::endl;
+            continue;
+        }
+        std::string root = dirTemplate;
+        for (const char* dir : {"/proc", "/sys", "/sys/devices", "/sys/devices/system", "/sys/devices/system/cpu"}) {
+            mkdir((root + dir).c_str(), 0755);
+        }
+        std::ofstream(root + "/sys/devices/system/cpu/present") << "0-" << cpuCount - 1 << "\n";
+        std::ofstream stat(root + "/proc/stat");
+        stat << "cpu  " << 2255ULL * cpuCount << " 34 2290 " << 22625563ULL * cpuCount << " 6290 127 456 0 0 0\n";
+        for (int i = 0; i < cpuCount; ++i) {
+            stat << "cpu" << i << " 1132 34 1441 11311718 3675 127 438 0 0 0\n";
+        }
+        stat << "intr 0\nctxt 123456789\nbtime 1700000000\nprocesses 1000\n";
+        stat.close();
+
+        SystemRoot::set(root);
+        CpuMonitor monitor;
+        SystemRoot::set(g_options.sysroot);
+        std::vector<float> usages(monitor.getNumberOfCpus(), 0);
+        addResult(measure(name, [&]() { monitor.getUsage(usages); }));
+        removeDirectory(root);
+    }
+}
+
+// Throughput of the writes of batches of records, as done by the file sink
+void benchEventsFile()
+{
+    const std::pair<const char*, unsigned long long> variants[] = {
+        {"events_file/write", 0},
+        {"events_file/write_rotating", 16 * 1024 * 1024}};
+    const size_t batchSize = 64 * 1024;
+    const unsigned long long maxBytes = 256 * 1024 * 1024ULL; // bounds the disk usage without rotation
+
+    std::string batch;
+    for (int i = 0; batch.size() < batchSize; ++i) {
+        batch += "time_exec;1700000000000;1700000000100;step_" + std::to_string(i) + "\n";
+    }
+
+    for (const auto& variant : variants) {
+        if (!selected(variant.first)) {
+            continue;
+        }
+        char dirTemplate[] = "/tmp/uprof-benchmark-XXXXXX";
+        if (!mkdtemp(dirTemplate)) {
+            std::cerr << "Cannot create a temporary directory, skipping " << variant.first << std::endl;
+            continue;
+        }
+        std::string dir = dirTemplate;
+        {
+            EventsFile file((dir + "/events.txt").c_str(), variant.second);
+            Result result = measure(variant.first, [&]() { file.write(batch.data(), batch.size()); }, maxBytes / batch.size());
+            result.extra.emplace_back("bytes_per_s", result.iterations * batch.size() * 1e9 / result.elapsed);
+            addResult(result);
+        }
+        removeDirectory(dir);
+    }
+}
+
+// Cost of each periodic dump, as measured by the scheduler running them
+void benchMonitors()
+{
+    std::atomic<unsigned long long> events(0);
+    UProfileImpl profiler;
+    profiler.addSink(new CallbackSink([&](const char*, size_t, size_t count) { events += count; }), {});
+    profiler.start(nullptr);
+
+    // Give the registries some content to dump
+    std::vector<std::unique_ptr<ProfiledMutex>> mutexes;
+    for (int i = 0; i < 16; ++i) {
+        std::string suffix = std::to_string(i);
+        CounterRegistry::instance().counterAdd("bench_counter_" + suffix, i);
+        CounterRegistry::instance().gaugeSet("bench_gauge_" + suffix, i);
+        CounterRegistry::instance().histogramRecord("bench_histogram_" + suffix, i);
+        mutexes.emplace_back(new ProfiledMutex("bench_mutex_" + suffix));
+        mutexes.back()->lock();
+        mutexes.back()->unlock();
+        FrameTracker::instance().mark("bench_channel_" + suffix);
+        FrameTracker::instance().mark("bench_channel_" + suffix);
+    }
+
+    const int period = 10;
+    profiler.startProcessMemoryMonitoring(period);
+    profiler.startSystemMemoryMonitoring(period);
+    profiler.startCPUUsageMonitoring(period);
+    profiler.startProcessIOMonitoring(period);
+    profiler.startDiskIOMonitoring(period);
+    profiler.startNetworkIOMonitoring(period);
+    profiler.startCgroupMonitoring(period);
+    profiler.startPressureMonitoring(period);
+    profiler.startThreadCPUMonitoring(period, 10);
+    profiler.startProcessesMonitoring(period, {static_cast<int>(getpid())}, true);
+    profiler.startCountersMonitoring(period);
+    profiler.startLockMonitoring(period);
+    profiler.startFrameMonitoring(period, false);
+    profiler.startSelfMonitoring(period);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(g_options.duration));
+    std::map<std::string, Scheduler::TaskStats> stats = profiler.getTaskStats();
+    profiler.stop();
+
+    for (auto it = stats.cbegin(); it != stats.cend(); ++it) {
+        std::string name = "monitor/" + it->first;
+        if (selected(name) && it->second.runs > 0) {
+            addResult({name, 1, it->second.runs, static_cast<double>(it->second.duration), {}});
+        }
+    }
+}
+
+std::string escape(const std::string& str)
+{
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeResults(std::ostream& out)
+{
+    out << "{\n"
+        << "  \"version\": \"" << escape(UPROFILE_VERSION) << "\",\n"
+        << "  \"date\": " << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() << ",\n"
+        << "  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"duration_ms\": " << g_options.duration << ",\n"
+        << "  \"sysroot\": \"" << escape(g_options.sysroot) << "\",\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const Result& result = g_results[i];
+        double nsPerOp = result.iterations > 0 ? result.elapsed / result.iterations : 0.;
+        out << (i > 0 ? "," : "") << "\n    {"
+            << "\"name\": \"" << escape(result.name) << "\", "
+            << "\"threads\": " << result.threads << ", "
+            << "\"iterations\": " << result.iterations << ", "
+            << "\"ns_per_op\": " << nsPerOp << ", "
+            << "\"ops_per_s\": " << (nsPerOp > 0. ? 1e9 / nsPerOp : 0.);
+        for (const auto& extra : result.extra) {
+            out << ", \"" << escape(extra.first) << "\": " << extra.second;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            g_options.output = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            g_options.filter = argv[++i];
+        } else if (arg == "--sysroot" && i + 1 < argc) {
+            g_options.sysroot = argv[++i];
+        } else if (arg == "--duration" && i + 1 < argc) {
+            g_options.duration = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--output <json file>] [--filter <name pattern>] [--sysroot <dir>] [--duration <ms per benchmark>]\n", argv[0]);
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (g_options.duration <= 0) {
+        fprintf(stderr, "Invalid duration: %d\n", g_options.duration);
+        return EXIT_FAILURE;
+    }
+
+    if (!g_options.sysroot.empty()) {
+        SystemRoot::set(g_options.sysroot);
+    }
+
+    benchTimestamps();
+    benchSpans();
+    benchEventsFile();
+    benchCpuMonitor();
+    benchMonitors();
+
+    if (g_options.output.empty()) {
+        writeResults(std::cout);
+        return EXIT_SUCCESS;
+    }
+    std::ofstream file(g_options.output);
+    writeResults(file);
+    if (!file) {
+        fprintf(stderr, "Failed to write %s\n", g_options.output.c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
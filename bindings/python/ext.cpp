@@ -20,6 +20,8 @@ namespace py = pybind11;
 void setPeriod(int period)
 {
 #if defined(GPU_MONITOR_NVIDIA)
+    // set_period() may be called several times: replace the monitor instead of adding another one
+    uprofile::removeGPUMonitor();
     uprofile::addGPUMonitor(new uprofile::NvidiaMonitor);
     uprofile::startGPUUsageMonitoring(period);
     uprofile::startGPUMemoryMonitoring(period);
@@ -40,7 +42,9 @@ PYBIND11_MODULE(pyuprofile, m)
     // Make Python bindings simpler than C++ APIs
     m.def("start", &uprofile::start, "Start profiling");
     m.def("stop", &uprofile::stop, "Stop profiling");
-    m.def("time_begin", &uprofile::timeBegin, "Start recording an event");
-    m.def("time_end", &uprofile::timeEnd, "Stop recording an event");
+    m.def("time_begin", &uprofile::timeBegin, "Start recording an event", py::arg("title"), py::arg("category") = uprofile::DEFAULT_CATEGORY);
+    m.def("time_end", &uprofile::timeEnd, "Stop recording an event", py::arg("title"), py::arg("category") = uprofile::DEFAULT_CATEGORY);
+    m.def("set_enabled", &uprofile::setEnabled, "Enable or disable the recording of events");
+    m.def("set_categories", &uprofile::setCategories, "Select the categories of events to record");
     m.def("set_period", setPeriod);
 }
@@ -0,0 +1,53 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include <signal.h>
+#include <sharedmemorycollector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <shared memory name> <output file> [max file size]\n", argv[0]);
+        fprintf(stderr, "Collect the events published by the processes profiling with a SharedMemorySink until SIGINT/SIGTERM\n");
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    // Stop signals are only delivered while waiting in sigsuspend() (and never to the collector thread)
+    sigset_t stopSignals, waitMask;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stopSignals, &waitMask);
+
+    uprofile::SharedMemoryCollector collector(argv[1], argv[2], argc > 3 ? strtoull(argv[3], nullptr, 10) : 0);
+    if (!collector.start()) {
+        return EXIT_FAILURE;
+    }
+    while (!stopRequested) {
+        sigsuspend(&waitMask);
+    }
+    collector.stop();
+    uprofile::SharedMemoryCollector::removeSegment(argv[1]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef ACTIVATION_H_
+#define ACTIVATION_H_
+
+#include <atomic>
+
+#include "api.h"
+
+namespace uprofile
+{
+
+// Categories are bits of a mask: an instrumented event belongs to one or several categories
+const unsigned long long DEFAULT_CATEGORY = 1ULL;
+const unsigned long long ALL_CATEGORIES = ~0ULL;
+
+namespace detail
+{
+// Categories currently recorded: 0 when profiling is disabled or not started
+UPROFAPI extern std::atomic<unsigned long long> activeCategories;
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Return if events of the given categories are currently recorded
+ *
+ * The check is a single relaxed atomic load so it can guard instrumentation in hot paths.
+ */
+inline bool isEnabled(unsigned long long categories = ALL_CATEGORIES)
+{
+    return (detail::activeCategories.load(std::memory_order_relaxed) & categories) != 0;
+}
+
+}
+
+#endif /* ACTIVATION_H_ */
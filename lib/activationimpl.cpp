@@ -0,0 +1,113 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "activationimpl.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <signal.h>
+#endif
+
+namespace uprofile
+{
+
+namespace detail
+{
+std::atomic<unsigned long long> activeCategories(0);
+}
+
+static bool getEnvEnabled()
+{
+    const char* value = std::getenv("UPROFILE_ENABLED");
+    return !value || std::strcmp(value, "0") != 0;
+}
+
+static unsigned long long getEnvCategories()
+{
+    const char* value = std::getenv("UPROFILE_CATEGORIES");
+    return value ? std::strtoull(value, NULL, 0) : ALL_CATEGORIES;
+}
+
+// Only lock-free atomics: the state is modified from a signal handler
+static std::atomic<int> g_nbStartedProfilers(0);
+static std::atomic<bool> g_enabled(getEnvEnabled());
+static std::atomic<unsigned long long> g_categories(getEnvCategories());
+
+void Activation::update()
+{
+    // Recompute until the inputs are stable, another thread or the signal
+    // handler may have changed them meanwhile
+    unsigned long long active;
+    do {
+        active = (g_enabled && g_nbStartedProfilers > 0) ? g_categories.load() : 0;
+        detail::activeCategories.store(active);
+    } while (active != ((g_enabled && g_nbStartedProfilers > 0) ? g_categories.load() : 0));
+}
+
+void Activation::profilerStarted()
+{
+    g_nbStartedProfilers++;
+    update();
+}
+
+void Activation::profilerStopped()
+{
+    g_nbStartedProfilers--;
+    update();
+}
+
+void Activation::setEnabled(bool enabled)
+{
+    g_enabled = enabled;
+    update();
+}
+
+bool Activation::enabled()
+{
+    return g_enabled;
+}
+
+void Activation::setCategories(unsigned long long categories)
+{
+    g_categories = categories;
+    update();
+}
+
+unsigned long long Activation::categories()
+{
+    return g_categories;
+}
+
+void Activation::onToggleSignal(int /*signum*/)
+{
+    g_enabled = !g_enabled;
+    update();
+}
+
+void Activation::enableSignalToggle(int signum)
+{
+#if defined(__linux__)
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &Activation::onToggleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, NULL) == -1) {
+        std::cerr << "Failed to install the profiling toggle signal handler" << std::endl;
+    }
+#else
+    (void)signum;
+    std::cerr << "Profiling toggle signal is not supported on this platform" << std::endl;
+#endif
+}
+
+}
@@ -0,0 +1,47 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef ACTIVATIONIMPL_H_
+#define ACTIVATIONIMPL_H_
+
+#include "activation.h"
+
+namespace uprofile
+{
+
+/**
+ * Process-wide runtime activation of the instrumentation
+ *
+ * Events are recorded when at least one profiler is started, profiling is
+ * enabled and their category is part of the categories mask. The initial state
+ * can be set with UPROFILE_ENABLED (0 or 1) and UPROFILE_CATEGORIES (mask, hexadecimal
+ * accepted with the 0x prefix) environment variables.
+ */
+class Activation
+{
+public:
+    static void profilerStarted();
+    static void profilerStopped();
+
+    static void setEnabled(bool enabled);
+    static bool enabled();
+    static void setCategories(unsigned long long categories);
+    static unsigned long long categories();
+
+    // Toggle the enabled state each time the given signal is received
+    static void enableSignalToggle(int signum);
+
+private:
+    static void update();
+    static void onToggleSignal(int signum);
+};
+
+}
+
+#endif /* ACTIVATIONIMPL_H_ */
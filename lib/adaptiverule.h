@@ -0,0 +1,45 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef ADAPTIVERULE_H_
+#define ADAPTIVERULE_H_
+
+#include <string>
+#include <vector>
+
+#include "monitortype.h"
+
+namespace uprofile
+{
+
+/**
+ * Rule temporarily switching monitors to a fast sampling period
+ *
+ * The rule triggers when a field of a monitored metric (any instance) goes
+ * above the threshold, or when its growth per second does if 'rate' is set.
+ * With the "time_exec" metric, it triggers when a span lasts at least
+ * 'threshold' ms (the field being the span title, or empty for all spans).
+ *
+ * The monitors are sampled every 'fastPeriod' ms until 'window' ms have elapsed
+ * without any new trigger, then they go back to their period.
+ */
+struct AdaptiveRule {
+    std::string name;   // recorded in the 'period' events
+    std::string metric; // e.g. "cpu", "proc_mem", "time_exec"
+    std::string field;  // e.g. "usage", "rss"
+    double threshold = 0.;
+    bool rate = false;
+    std::vector<MonitorType> monitors;
+    int fastPeriod = 0; // ms
+    int window = 0;     // ms
+};
+
+}
+
+#endif /* ADAPTIVERULE_H_ */
@@ -0,0 +1,211 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "counters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+namespace uprofile
+{
+
+static const size_t CACHE_LINE_SIZE = 64;
+
+// Cells are only written by their owner thread: a relaxed load and store
+// is enough and avoids any locked instruction
+template <typename T>
+static void ownerAdd(std::atomic<T>& cell, T delta)
+{
+    cell.store(cell.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Cells are padded so that two threads never update the same cache line
+struct CounterCell {
+    std::atomic<long long> value;
+    char padding[CACHE_LINE_SIZE - sizeof(std::atomic<long long>)];
+
+    CounterCell() :
+        value(0) {}
+};
+
+struct GaugeCell {
+    std::atomic<double> value;
+    std::atomic<long long> time; // time of the last update, the most recent value of all threads wins
+    char padding[CACHE_LINE_SIZE - sizeof(std::atomic<double>) - sizeof(std::atomic<long long>)];
+
+    GaugeCell() :
+        value(0.), time(0) {}
+};
+
+struct HistogramCell {
+    std::atomic<double> sum;
+    std::atomic<unsigned long long> buckets[Histogram::BUCKETS_NUMBER];
+    char padding[CACHE_LINE_SIZE];
+
+    HistogramCell() :
+        sum(0.)
+    {
+        for (int i = 0; i < Histogram::BUCKETS_NUMBER; ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void collect(Histogram& histogram) const
+    {
+        for (int i = 0; i < Histogram::BUCKETS_NUMBER; ++i) {
+            unsigned long long count = buckets[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                histogram.addBucket(i, count);
+            }
+        }
+        histogram.addSum(sum.load(std::memory_order_relaxed));
+    }
+};
+
+struct CounterRegistry::Shard {
+    // Held by the owner when adding a new name and by the collector while reading
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<CounterCell>> counters;
+    std::unordered_map<std::string, std::unique_ptr<GaugeCell>> gauges;
+    std::unordered_map<std::string, std::unique_ptr<HistogramCell>> histograms;
+
+    template <typename Cell>
+    Cell& cell(std::unordered_map<std::string, std::unique_ptr<Cell>>& cells, const std::string& name)
+    {
+        // Lookups by the owner are safe without lock: only the owner modifies the map
+        auto it = cells.find(name);
+        if (it != cells.end()) {
+            return *it->second;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        Cell* newCell = new Cell;
+        cells[name].reset(newCell);
+        return *newCell;
+    }
+};
+
+namespace
+{
+struct ShardHolder {
+    CounterRegistry::Shard* shard = nullptr;
+
+    ~ShardHolder()
+    {
+        if (shard) {
+            CounterRegistry::instance().retireShard(shard);
+        }
+    }
+};
+thread_local ShardHolder t_shardHolder;
+
+long long now()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+}
+
+CounterRegistry& CounterRegistry::instance()
+{
+    // Never destroyed: threads may exit (and retire their shard) after static destruction
+    static CounterRegistry* registry = new CounterRegistry;
+    return *registry;
+}
+
+CounterRegistry::CounterRegistry()
+{
+}
+
+CounterRegistry::Shard& CounterRegistry::localShard()
+{
+    if (!t_shardHolder.shard) {
+        Shard* shard = new Shard;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shards.push_back(shard);
+        t_shardHolder.shard = shard;
+    }
+    return *t_shardHolder.shard;
+}
+
+void CounterRegistry::counterAdd(const std::string& name, long long delta)
+{
+    Shard& shard = localShard();
+    ownerAdd(shard.cell(shard.counters, name).value, delta);
+}
+
+void CounterRegistry::gaugeSet(const std::string& name, double value)
+{
+    Shard& shard = localShard();
+    GaugeCell& cell = shard.cell(shard.gauges, name);
+    cell.value.store(value, std::memory_order_relaxed);
+    cell.time.store(now(), std::memory_order_release);
+}
+
+void CounterRegistry::histogramRecord(const std::string& name, double value)
+{
+    Shard& shard = localShard();
+    HistogramCell& cell = shard.cell(shard.histograms, name);
+    ownerAdd(cell.buckets[Histogram::bucketIndex(value)], 1ULL);
+    ownerAdd(cell.sum, value);
+}
+
+CounterRegistry::Snapshot CounterRegistry::collect()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Snapshot snapshot = m_retired;
+    std::map<std::string, long long> gaugeTimes = m_retiredGaugeTimes;
+
+    for (auto shardIt = m_shards.cbegin(); shardIt != m_shards.cend(); ++shardIt) {
+        Shard& shard = **shardIt;
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        for (auto it = shard.counters.cbegin(); it != shard.counters.cend(); ++it) {
+            snapshot.counters[it->first] += it->second->value.load(std::memory_order_relaxed);
+        }
+        for (auto it = shard.gauges.cbegin(); it != shard.gauges.cend(); ++it) {
+            long long time = it->second->time.load(std::memory_order_acquire);
+            auto timeIt = gaugeTimes.find(it->first);
+            if (timeIt == gaugeTimes.end() || time > timeIt->second) {
+                gaugeTimes[it->first] = time;
+                snapshot.gauges[it->first] = it->second->value.load(std::memory_order_relaxed);
+            }
+        }
+        for (auto it = shard.histograms.cbegin(); it != shard.histograms.cend(); ++it) {
+            it->second->collect(snapshot.histograms[it->first]);
+        }
+    }
+    return snapshot;
+}
+
+void CounterRegistry::retireShard(Shard* shard)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        for (auto it = shard->counters.cbegin(); it != shard->counters.cend(); ++it) {
+            m_retired.counters[it->first] += it->second->value.load(std::memory_order_relaxed);
+        }
+        for (auto it = shard->gauges.cbegin(); it != shard->gauges.cend(); ++it) {
+            long long time = it->second->time.load(std::memory_order_acquire);
+            auto timeIt = m_retiredGaugeTimes.find(it->first);
+            if (timeIt == m_retiredGaugeTimes.end() || time > timeIt->second) {
+                m_retiredGaugeTimes[it->first] = time;
+                m_retired.gauges[it->first] = it->second->value.load(std::memory_order_relaxed);
+            }
+        }
+        for (auto it = shard->histograms.cbegin(); it != shard->histograms.cend(); ++it) {
+            it->second->collect(m_retired.histograms[it->first]);
+        }
+    }
+    m_shards.erase(std::remove(m_shards.begin(), m_shards.end(), shard), m_shards.end());
+    delete shard;
+}
+
+}
@@ -0,0 +1,65 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+#include "util/histogram.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Process-wide registry of application counters, gauges and histograms
+ *
+ * Values are recorded into per-thread shards: updating a metric from the
+ * owner thread is an uncontended store on a cache-line padded cell. Shards
+ * are only locked when a thread records a name for the first time and when
+ * the sampler aggregates them with collect().
+ */
+class CounterRegistry
+{
+public:
+    struct Snapshot {
+        std::map<std::string, long long> counters;
+        std::map<std::string, double> gauges;
+        std::map<std::string, Histogram> histograms; // cumulated since the process start
+    };
+
+    // Per-thread storage, defined in the implementation
+    struct Shard;
+
+    static CounterRegistry& instance();
+
+    void counterAdd(const std::string& name, long long delta);
+    void gaugeSet(const std::string& name, double value);
+    void histogramRecord(const std::string& name, double value);
+
+    Snapshot collect();
+
+    // Merge the values of a thread that exits
+    void retireShard(Shard* shard);
+
+private:
+    CounterRegistry();
+    Shard& localShard();
+
+    std::mutex m_mutex;
+    std::vector<Shard*> m_shards;
+    Snapshot m_retired;
+    std::map<std::string, long long> m_retiredGaugeTimes;
+};
+
+}
+
+#endif /* COUNTERS_H_ */
@@ -10,7 +10,7 @@
 #include "eventsfile.h"
 
 #include <iostream>
-#include <sstream>
+#include <string.h>
 
 using namespace std;
 
@@ -44,26 +44,30 @@ EventsFile::~EventsFile()
     m_file.close();
 }
 
-void EventsFile::write(const std::string& event, unsigned long long timestamp, const std::list<std::string>& data)
+void EventsFile::write(const char* records, size_t size)
 {
-    string csvSeparator(";");
-    stringstream ss;
-    ss << event << csvSeparator << timestamp;
-    for (auto it = data.cbegin(); it != data.cend(); ++it) {
-        ss << csvSeparator << *it;
+    std::lock_guard<std::mutex> guard(m_fileMutex);
+    if (m_maxCapSize == 0) {
+        m_file.write(records, size);
+        m_file.flush();
+        m_currentFileSize += size;
+        return;
     }
-    ss << "\n";
-    string line = ss.str();
 
     // Total size of all rotating files should never exceed the defined max cap size
-    std::lock_guard<std::mutex> guard(m_fileMutex);
-    if (m_maxCapSize > 0 && m_currentFileSize + line.size() > m_maxCapSize / ROTATING_FILES_NUMBER) {
-        rotateFile();
+    // so the batch is split on record boundaries
+    const char* end = records + size;
+    while (records < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(records, '\n', end - records));
+        size_t lineSize = lineEnd ? lineEnd - records + 1 : end - records;
+        if (m_currentFileSize + lineSize > m_maxCapSize / ROTATING_FILES_NUMBER) {
+            rotateFile();
+        }
+        m_file.write(records, lineSize);
+        m_currentFileSize += lineSize;
+        records += lineSize;
     }
-
-    m_file << line;
     m_file.flush();
-    m_currentFileSize += line.size();
 }
 
 void EventsFile::rotateFile()
@@ -11,7 +11,6 @@
 #define EVENTSFILE_H_
 
 #include <fstream>
-#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -26,7 +25,8 @@ public:
     EventsFile(const char* filepath, unsigned long long maxCapSize);
     ~EventsFile();
 
-    void write(const std::string& event, unsigned long long timestamp, const std::list<std::string>& data);
+    // Write a batch of records (each record is terminated by '\n')
+    void write(const char* records, size_t size);
 
     static const int ROTATING_FILES_NUMBER = 2;
 
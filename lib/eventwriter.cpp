@@ -0,0 +1,247 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "eventwriter.h"
+
+#include <chrono>
+
+namespace uprofile
+{
+
+static const char csvSeparator = ';';
+
+const size_t EventWriter::BATCH_SIZE;
+const size_t EventWriter::MAX_PENDING_SIZE;
+const int EventWriter::FLUSH_PERIOD;
+
+bool EventWriter::SinkEntry::accepts(const char* event) const
+{
+    if (events.empty()) {
+        return true;
+    }
+    for (auto it = events.cbegin(); it != events.cend(); ++it) {
+        if (*it == event) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t EventWriter::SinkEntry::take(std::string& records)
+{
+    records.swap(batch);
+    size_t taken = count;
+    count = 0;
+    if (dropped > 0) {
+        // Let the sink know that records are missing
+        records += "dropped";
+        records += csvSeparator;
+        records += std::to_string(lastDropped);
+        records += csvSeparator;
+        records += std::to_string(dropped);
+        records += '\n';
+        taken++;
+        dropped = 0;
+    }
+    return taken;
+}
+
+EventWriter::EventWriter() :
+    m_nbSinks(0),
+    m_recorder(nullptr),
+    m_selfStats(nullptr)
+{
+}
+
+EventWriter::~EventWriter()
+{
+    stopThread();
+    flush();
+}
+
+void EventWriter::addSink(IEventSink* sink, const std::vector<std::string>& events)
+{
+    std::unique_ptr<SinkEntry> entry(new SinkEntry);
+    entry->sink.reset(sink);
+    entry->events = events;
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_sinks.push_back(std::move(entry));
+    m_nbSinks = m_sinks.size();
+    lk.unlock();
+
+    startThread();
+}
+
+void EventWriter::removeSink(IEventSink* sink)
+{
+    std::lock_guard<std::mutex> flushGuard(m_flushMutex);
+    std::unique_ptr<SinkEntry> entry;
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+        if ((*it)->sink.get() == sink) {
+            entry = std::move(*it);
+            m_sinks.erase(it);
+            break;
+        }
+    }
+    m_nbSinks = m_sinks.size();
+    lk.unlock();
+
+    if (entry && (entry->count > 0 || entry->dropped > 0)) {
+        std::string batch;
+        size_t count = entry->take(batch);
+        entry->sink->write(batch.data(), batch.size(), count);
+    }
+}
+
+bool EventWriter::hasSinks() const
+{
+    return m_nbSinks > 0;
+}
+
+void EventWriter::setRecorder(FlightRecorder* recorder)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_recorder = recorder;
+}
+
+void EventWriter::setSelfStats(SelfStats* stats)
+{
+    m_selfStats = stats;
+}
+
+void EventWriter::write(const char* event, unsigned long long timestamp, const std::list<std::string>& data)
+{
+    if (!hasSinks() && !m_recorder.load(std::memory_order_relaxed)) {
+        return;
+    }
+    SelfStats* stats = m_selfStats.load(std::memory_order_relaxed);
+    unsigned long long begin = stats ? SelfStats::now() : 0;
+
+    // Encode the record once for all sinks
+    std::string record(event);
+    record += csvSeparator;
+    record += std::to_string(timestamp);
+    for (auto it = data.cbegin(); it != data.cend(); ++it) {
+        record += csvSeparator;
+        record += *it;
+    }
+    record += '\n';
+
+    bool flushNeeded = false;
+    std::unique_lock<std::mutex> lk(m_mutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+        // Only timed when contended (by other producers or the writer thread taking the batches)
+        unsigned long long waitBegin = stats ? SelfStats::now() : 0;
+        lk.lock();
+        if (stats) {
+            stats->add(SelfStats::LOCK_WAIT, SelfStats::now() - waitBegin);
+        }
+    }
+    m_counters.events++;
+    m_counters.bytes += record.size();
+    FlightRecorder* recorder = m_recorder.load(std::memory_order_relaxed);
+    if (recorder) {
+        // Records reach the recorder immediately (not batched) so that a crash dump holds the latest ones
+        recorder->append(record.data(), record.size());
+    }
+    for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+        SinkEntry& entry = **it;
+        if (!entry.accepts(event)) {
+            continue;
+        }
+        if (entry.batch.size() + record.size() > MAX_PENDING_SIZE) {
+            // The sink does not keep up: do not grow the memory forever
+            m_counters.dropped++;
+            entry.dropped++;
+            entry.lastDropped = timestamp;
+            continue;
+        }
+        entry.batch += record;
+        entry.count++;
+        flushNeeded |= entry.batch.size() >= BATCH_SIZE;
+    }
+    lk.unlock();
+
+    if (flushNeeded) {
+        m_flushCondition.notify_one();
+    }
+    if (stats) {
+        stats->add(SelfStats::WRITE_TIME, SelfStats::now() - begin);
+    }
+}
+
+void EventWriter::flush()
+{
+    std::lock_guard<std::mutex> flushGuard(m_flushMutex);
+
+    // Take the pending batches so that producers are not blocked by the sinks
+    std::vector<std::pair<IEventSink*, std::string>> batches;
+    std::vector<size_t> counts;
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+        SinkEntry& entry = **it;
+        if (entry.count == 0 && entry.dropped == 0) {
+            continue;
+        }
+        batches.push_back(std::make_pair(entry.sink.get(), std::string()));
+        counts.push_back(entry.take(batches.back().second));
+    }
+    lk.unlock();
+
+    for (size_t i = 0; i < batches.size(); ++i) {
+        const std::string& batch = batches[i].second;
+        batches[i].first->write(batch.data(), batch.size(), counts[i]);
+    }
+}
+
+EventWriter::Counters EventWriter::counters()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_counters;
+}
+
+unsigned long long EventWriter::threadCpuTime()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_thread ? SelfStats::threadCpuTime(m_thread.get()) : 0;
+}
+
+void EventWriter::startThread()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_thread) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::unique_ptr<std::thread>(new std::thread([this]() {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (m_running) {
+            m_flushCondition.wait_for(lk, std::chrono::milliseconds(FLUSH_PERIOD));
+            lk.unlock();
+            flush();
+            lk.lock();
+        }
+    }));
+}
+
+void EventWriter::stopThread()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_running = false;
+    lk.unlock();
+    m_flushCondition.notify_one();
+    if (m_thread) {
+        m_thread->join();
+        m_thread.reset();
+    }
+}
+
+}
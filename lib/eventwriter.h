@@ -0,0 +1,106 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef EVENTWRITER_H_
+#define EVENTWRITER_H_
+
+#include "ieventsink.h"
+#include "util/flightrecorder.h"
+#include "util/selfstats.h"
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Encode events and dispatch them to the registered sinks
+ *
+ * Each event is encoded once as a CSV record and appended to the batch of
+ * every sink whose filter accepts it. Batches are handed to the sinks by a
+ * writer thread, periodically or as soon as a batch is large enough.
+ *
+ * Events are dropped for a sink holding MAX_PENDING_SIZE bytes of pending
+ * records: a 'dropped;<timestamp>;<count>' record then tells the sink how many
+ * were lost, the timestamp being the one of the last dropped event.
+ */
+class EventWriter
+{
+public:
+    struct Counters {
+        unsigned long long events = 0; // events encoded
+        unsigned long long bytes = 0;  // bytes encoded
+        unsigned long long dropped = 0;
+    };
+
+    EventWriter();
+    ~EventWriter();
+
+    // Takes ownership of the sink. An empty events list accepts all events
+    void addSink(IEventSink* sink, const std::vector<std::string>& events);
+    // Flush and destroy the sink
+    void removeSink(IEventSink* sink);
+    bool hasSinks() const;
+    // Also append each record to the flight recorder (nullptr to disable)
+    void setRecorder(FlightRecorder* recorder);
+    // Measure the time spent in write() (nullptr to disable)
+    void setSelfStats(SelfStats* stats);
+
+    void write(const char* event, unsigned long long timestamp, const std::list<std::string>& data);
+    // Hand all pending batches to the sinks
+    void flush();
+
+    Counters counters();
+    // CPU time (in ns) consumed by the writer thread
+    unsigned long long threadCpuTime();
+
+    static const size_t BATCH_SIZE = 64 * 1024;              // bytes triggering a flush
+    static const size_t MAX_PENDING_SIZE = 8 * 1024 * 1024; // bytes over which events are dropped
+    static const int FLUSH_PERIOD = 100;                     // ms
+
+private:
+    struct SinkEntry {
+        std::unique_ptr<IEventSink> sink;
+        std::vector<std::string> events;
+        std::string batch;
+        size_t count = 0;
+        unsigned long long dropped = 0;       // events dropped since the last batch
+        unsigned long long lastDropped = 0;   // timestamp of the last dropped event
+
+        bool accepts(const char* event) const;
+        // Move the pending records to 'records', followed by a 'dropped' record if events were dropped,
+        // and return their number
+        size_t take(std::string& records);
+    };
+
+    void startThread();
+    void stopThread();
+
+    std::vector<std::unique_ptr<SinkEntry>> m_sinks;
+    std::atomic<size_t> m_nbSinks;
+    std::atomic<FlightRecorder*> m_recorder;
+    std::atomic<SelfStats*> m_selfStats;
+    Counters m_counters;
+
+    std::mutex m_mutex;      // protects sinks and batches
+    std::mutex m_flushMutex; // keeps batches ordered and sinks alive while writing
+    std::condition_variable m_flushCondition;
+    std::unique_ptr<std::thread> m_thread;
+    bool m_running = false;
+};
+
+}
+
+#endif /* EVENTWRITER_H_ */
@@ -0,0 +1,185 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "frametracker.h"
+
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+
+namespace uprofile
+{
+
+const int FrameTracker::RAW_FRAMES;
+
+// Channels may be marked by several threads: values are updated with atomic
+// read-modify-write operations (uncontended for a single render thread)
+static void atomicAdd(std::atomic<double>& cell, double delta)
+{
+    double value = cell.load(std::memory_order_relaxed);
+    while (!cell.compare_exchange_weak(value, value + delta, std::memory_order_relaxed)) {
+    }
+}
+
+struct FrameTracker::Channel {
+    std::atomic<unsigned long long> last;   // ns of the previous mark
+    std::atomic<double> period;             // ms between two frames at the expected rate, 0 if unknown
+    std::atomic<unsigned long long> frames;
+    std::atomic<unsigned long long> missed;
+    std::atomic<double> sum;
+    std::atomic<double> sumSquares;
+    std::atomic<unsigned long long> buckets[Histogram::BUCKETS_NUMBER];
+
+    // Ring of the raw frames, read by the collector from rawRead to rawWritten
+    std::atomic<unsigned long long> rawWritten;
+    unsigned long long rawRead;
+    std::atomic<unsigned long long> rawTimes[RAW_FRAMES];
+    std::atomic<double> rawFrameTimes[RAW_FRAMES];
+
+    Channel() :
+        last(0), period(0.), frames(0), missed(0), sum(0.), sumSquares(0.), rawWritten(0), rawRead(0)
+    {
+        for (int i = 0; i < Histogram::BUCKETS_NUMBER; ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < RAW_FRAMES; ++i) {
+            rawTimes[i].store(0, std::memory_order_relaxed);
+            rawFrameTimes[i].store(0., std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace
+{
+// Channels are never destroyed: the cache of a thread stays valid
+thread_local std::unordered_map<std::string, FrameTracker::Channel*> t_channels;
+}
+
+FrameTracker& FrameTracker::instance()
+{
+    // Never destroyed: threads may mark frames during static destruction
+    static FrameTracker* tracker = new FrameTracker;
+    return *tracker;
+}
+
+FrameTracker::FrameTracker() :
+    m_rawFrames(false)
+{
+}
+
+unsigned long long FrameTracker::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameTracker::Channel& FrameTracker::channel(const std::string& name)
+{
+    auto it = t_channels.find(name);
+    if (it != t_channels.end()) {
+        return *it->second;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_ptr<Channel>& channel = m_channels[name];
+    if (!channel) {
+        channel.reset(new Channel);
+    }
+    t_channels[name] = channel.get();
+    return *channel;
+}
+
+void FrameTracker::mark(const std::string& name)
+{
+    Channel& channel = this->channel(name);
+    unsigned long long time = now();
+    unsigned long long last = channel.last.exchange(time, std::memory_order_relaxed);
+    if (last == 0 || time <= last) {
+        // First frame of the channel: no frame time yet
+        return;
+    }
+
+    double frameTime = (time - last) / 1000000.;
+    channel.frames.fetch_add(1, std::memory_order_relaxed);
+    atomicAdd(channel.sum, frameTime);
+    atomicAdd(channel.sumSquares, frameTime * frameTime);
+    channel.buckets[Histogram::bucketIndex(frameTime)].fetch_add(1, std::memory_order_relaxed);
+
+    double period = channel.period.load(std::memory_order_relaxed);
+    if (period > 0. && frameTime > 1.5 * period) {
+        channel.missed.fetch_add(static_cast<unsigned long long>(std::lround(frameTime / period)) - 1, std::memory_order_relaxed);
+    }
+
+    if (m_rawFrames.load(std::memory_order_relaxed)) {
+        unsigned long long index = channel.rawWritten.load(std::memory_order_relaxed);
+        // Concurrent marks of a channel may overwrite a slot: only the raw frame is lost
+        channel.rawTimes[index % RAW_FRAMES].store(time, std::memory_order_relaxed);
+        channel.rawFrameTimes[index % RAW_FRAMES].store(frameTime, std::memory_order_relaxed);
+        channel.rawWritten.store(index + 1, std::memory_order_release);
+    }
+}
+
+void FrameTracker::setFrameRate(const std::string& name, double fps)
+{
+    channel(name).period.store(fps > 0. ? 1000. / fps : 0., std::memory_order_relaxed);
+}
+
+void FrameTracker::setRawFrames(bool enabled)
+{
+    m_rawFrames = enabled;
+}
+
+std::map<std::string, FrameTracker::Snapshot> FrameTracker::collect()
+{
+    std::map<std::string, Snapshot> snapshots;
+    unsigned long long time = now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_channels.cbegin(); it != m_channels.cend(); ++it) {
+        const Channel& channel = *it->second;
+        Snapshot& snapshot = snapshots[it->first];
+        snapshot.time = time;
+        snapshot.frames = channel.frames.load(std::memory_order_relaxed);
+        snapshot.missed = channel.missed.load(std::memory_order_relaxed);
+        snapshot.sum = channel.sum.load(std::memory_order_relaxed);
+        snapshot.sumSquares = channel.sumSquares.load(std::memory_order_relaxed);
+        for (int i = 0; i < Histogram::BUCKETS_NUMBER; ++i) {
+            unsigned long long count = channel.buckets[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                snapshot.frameTimes.addBucket(i, count);
+            }
+        }
+        snapshot.frameTimes.addSum(snapshot.sum);
+    }
+    return snapshots;
+}
+
+std::map<std::string, std::vector<FrameTracker::RawFrame>> FrameTracker::collectRawFrames()
+{
+    std::map<std::string, std::vector<RawFrame>> frames;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
+        Channel& channel = *it->second;
+        unsigned long long written = channel.rawWritten.load(std::memory_order_acquire);
+        if (written - channel.rawRead > static_cast<unsigned long long>(RAW_FRAMES)) {
+            // Frames overwritten before being collected
+            channel.rawRead = written - RAW_FRAMES;
+        }
+        if (channel.rawRead == written) {
+            continue;
+        }
+        std::vector<RawFrame>& channelFrames = frames[it->first];
+        for (; channel.rawRead < written; ++channel.rawRead) {
+            RawFrame frame;
+            frame.time = channel.rawTimes[channel.rawRead % RAW_FRAMES].load(std::memory_order_relaxed);
+            frame.frameTime = channel.rawFrameTimes[channel.rawRead % RAW_FRAMES].load(std::memory_order_relaxed);
+            channelFrames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+}
@@ -0,0 +1,79 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef FRAMETRACKER_H_
+#define FRAMETRACKER_H_
+
+#include "util/histogram.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Process-wide tracking of the frame (or loop iteration) pacing of channels
+ *
+ * Each mark records the time elapsed since the previous mark of the channel
+ * into lock-free per-channel state: atomic counters, sums and histogram
+ * buckets. Channels are looked up through a per-thread cache, the registry
+ * is only locked when a thread marks a channel for the first time and when
+ * collecting.
+ */
+class FrameTracker
+{
+public:
+    struct Snapshot {
+        unsigned long long time = 0; // ns (steady clock) of the collect
+        unsigned long long frames = 0;
+        unsigned long long missed = 0; // frame periods skipped
+        double sum = 0.;               // ms
+        double sumSquares = 0.;        // ms^2
+        Histogram frameTimes;          // ms, cumulated since the first mark
+    };
+
+    struct RawFrame {
+        unsigned long long time; // ns (steady clock) of the mark
+        double frameTime;        // ms
+    };
+
+    // Per channel storage, defined in the implementation
+    struct Channel;
+
+    static const int RAW_FRAMES = 4096; // frames kept per channel between two collects
+
+    static FrameTracker& instance();
+
+    void mark(const std::string& channel);
+    // Frames lasting more than 1.5 periods of the given rate are counted as missed (0 to disable)
+    void setFrameRate(const std::string& channel, double fps);
+    void setRawFrames(bool enabled);
+
+    std::map<std::string, Snapshot> collect();
+    // Return the frames marked since the previous call (oldest first)
+    std::map<std::string, std::vector<RawFrame>> collectRawFrames();
+
+    static unsigned long long now(); // ns (steady clock)
+
+private:
+    FrameTracker();
+    Channel& channel(const std::string& name);
+
+    std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<Channel>> m_channels;
+    std::atomic<bool> m_rawFrames;
+};
+
+}
+
+#endif /* FRAMETRACKER_H_ */
@@ -0,0 +1,40 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef IEVENTSINK_H_
+#define IEVENTSINK_H_
+
+#include <cstddef>
+
+namespace uprofile
+{
+
+/**
+ * Interface to implement for receiving the recorded events
+ *
+ * Events are encoded once by the library and handed to each sink
+ * by batches: a batch is a contiguous buffer of CSV records, each
+ * record being terminated by a '\n' character.
+ *
+ * Calls to write() are serialized, but they may come from different
+ * threads: the writer thread, and the thread flushing the pending
+ * batches when the profiler stops or the sink is removed.
+ */
+class IEventSink
+{
+public:
+    virtual ~IEventSink() {}
+
+    // Process a batch of 'count' records held in 'size' bytes
+    virtual void write(const char* records, size_t size, size_t count) = 0;
+};
+
+}
+
+#endif /* IEVENTSINK_H_ */
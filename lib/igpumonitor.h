@@ -10,6 +10,7 @@
 #ifndef IGPUMONITOR_H_
 #define IGPUMONITOR_H_
 
+#include <string>
 #include <vector>
 
 namespace uprofile
@@ -39,6 +40,8 @@ public:
     virtual const std::vector<float>& getUsage() const = 0;
     // usedMems and totalMems should be returned as KiB
     virtual void getMemory(std::vector<int>& usedMem, std::vector<int>& totalMem) const = 0;
+    // Label of each GPU (e.g. its device name), GPUs are numbered when no label is given
+    virtual std::vector<std::string> getNames() const { return std::vector<std::string>(); }
 };
 
 }
@@ -0,0 +1,51 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef IMETRICMONITOR_H_
+#define IMETRICMONITOR_H_
+
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Description of the series produced by a metric monitor
+ *
+ * Each sample produces one record per instance (or a single record
+ * if there is no instance) holding one value per field:
+ *   <name>;<timestamp>;[<instance>;]<field 1>;<field 2>;...
+ */
+struct MetricSchema {
+    std::string name;                   // event type (e.g. "queue")
+    std::vector<std::string> instances; // e.g. one instance per queue, can be empty
+    std::vector<std::string> fields;    // e.g. {"depth", "capacity"}
+};
+
+/**
+ * Interface to implement for monitoring a custom periodic source
+ *
+ * The schema is read once when the monitor is added. Then sample() is
+ * called at each period from the shared monitoring thread of the profiler,
+ * with a buffer preallocated for 'instances x fields' values
+ * (values of the first instance first).
+ */
+class IMetricMonitor
+{
+public:
+    virtual ~IMetricMonitor() {}
+
+    virtual MetricSchema schema() const = 0;
+    virtual void sample(double* values) = 0;
+};
+
+}
+
+#endif /* IMETRICMONITOR_H_ */
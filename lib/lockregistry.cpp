@@ -0,0 +1,75 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "lockregistry.h"
+
+namespace uprofile
+{
+
+LockRegistry& LockRegistry::instance()
+{
+    // Never destroyed: static locks of the application may outlive the registry otherwise
+    static LockRegistry* registry = new LockRegistry;
+    return *registry;
+}
+
+LockStats* LockRegistry::attach(const std::string& name, const std::atomic<unsigned long long>* acquisitions)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::unique_ptr<LockStats>& stats = m_stats[name];
+    if (!stats) {
+        stats.reset(new LockStats);
+    }
+    std::lock_guard<std::mutex> statsGuard(stats->mutex);
+    stats->instances.insert(acquisitions);
+    return stats.get();
+}
+
+void LockRegistry::detach(LockStats* stats, const std::atomic<unsigned long long>* acquisitions)
+{
+    std::lock_guard<std::mutex> guard(stats->mutex);
+    stats->retiredAcquisitions += acquisitions->load(std::memory_order_relaxed);
+    stats->instances.erase(acquisitions);
+}
+
+void LockRegistry::recordWait(LockStats* stats, unsigned long long duration, bool contention)
+{
+    std::lock_guard<std::mutex> guard(stats->mutex);
+    if (contention) {
+        stats->contentions++;
+    }
+    stats->wait.record(duration / 1000.);
+}
+
+void LockRegistry::recordHold(LockStats* stats, unsigned long long duration)
+{
+    std::lock_guard<std::mutex> guard(stats->mutex);
+    stats->hold.record(duration / 1000.);
+}
+
+std::map<std::string, LockRegistry::Snapshot> LockRegistry::collect()
+{
+    std::map<std::string, Snapshot> snapshots;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_stats.cbegin(); it != m_stats.cend(); ++it) {
+        LockStats& stats = *it->second;
+        Snapshot& snapshot = snapshots[it->first];
+        std::lock_guard<std::mutex> statsGuard(stats.mutex);
+        snapshot.acquisitions = stats.retiredAcquisitions;
+        for (auto instance = stats.instances.cbegin(); instance != stats.instances.cend(); ++instance) {
+            snapshot.acquisitions += (*instance)->load(std::memory_order_relaxed);
+        }
+        snapshot.contentions = stats.contentions;
+        snapshot.wait = stats.wait;
+        snapshot.hold = stats.hold;
+    }
+    return snapshots;
+}
+
+}
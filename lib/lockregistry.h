@@ -0,0 +1,72 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef LOCKREGISTRY_H_
+#define LOCKREGISTRY_H_
+
+#include "util/histogram.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace uprofile
+{
+
+// Statistics shared by the locks of a same name
+struct LockStats {
+    std::mutex mutex; // only taken on the slow paths
+    std::set<const std::atomic<unsigned long long>*> instances;
+    unsigned long long retiredAcquisitions = 0;
+    unsigned long long contentions = 0;
+    Histogram wait;
+    Histogram hold;
+};
+
+/**
+ * Process-wide registry of the contention statistics of the profiled locks
+ *
+ * Locks sharing a name share their statistics. Acquisitions are counted by
+ * each lock instance (the registry only reads them when collecting) so that
+ * the uncontended path never writes a shared cache line. Wait and hold times
+ * are recorded into histograms on the slow paths only.
+ */
+class LockRegistry
+{
+public:
+    struct Snapshot {
+        unsigned long long acquisitions = 0;
+        unsigned long long contentions = 0;
+        Histogram wait; // us, cumulated since the process start
+        Histogram hold; // us, cumulated since the process start
+    };
+
+    static LockRegistry& instance();
+
+    // Register a lock instance counting its acquisitions into 'acquisitions'
+    LockStats* attach(const std::string& name, const std::atomic<unsigned long long>* acquisitions);
+    void detach(LockStats* stats, const std::atomic<unsigned long long>* acquisitions);
+
+    static void recordWait(LockStats* stats, unsigned long long duration /* ns */, bool contention = true);
+    static void recordHold(LockStats* stats, unsigned long long duration /* ns */);
+
+    std::map<std::string, Snapshot> collect();
+
+private:
+    LockRegistry() = default;
+
+    std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<LockStats>> m_stats;
+};
+
+}
+
+#endif /* LOCKREGISTRY_H_ */
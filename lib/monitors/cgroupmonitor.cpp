@@ -0,0 +1,118 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "cgroupmonitor.h"
+#include "util/counterrates.h"
+#include "util/procfile.h"
+#include "util/systemroot.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace uprofile
+{
+
+static const char CGROUP_ROOT[] = "/sys/fs/cgroup";
+static const char* const CPU_STAT_KEYS[] = {"usage_usec", "nr_periods", "nr_throttled", "throttled_usec"};
+static const size_t CPU_STAT_KEYS_NUMBER = 4;
+
+// Parse the value of each key of a '<key> <value>' flat keyed file
+static void parseKeyedFile(const char* pos, const char* const* keys, size_t nbKeys, unsigned long long* values)
+{
+    while (pos && *pos != '\0') {
+        size_t length = ProcFile::wordLength(pos);
+        for (size_t i = 0; i < nbKeys; ++i) {
+            if (strlen(keys[i]) == length && strncmp(keys[i], pos, length) == 0) {
+                ProcFile::parseNumber(pos + length, values[i]);
+                break;
+            }
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+}
+
+CgroupMonitor::CgroupMonitor(const std::string& cgroupDir) :
+    m_dir(cgroupDir.empty() ? findCgroupDirectory() : cgroupDir),
+    m_cpuStat(new ProcFile(m_dir + "/cpu.stat")),
+    m_memoryCurrent(new ProcFile(m_dir + "/memory.current")),
+    m_memoryMax(new ProcFile(m_dir + "/memory.max")),
+    m_memoryStat(new ProcFile(m_dir + "/memory.stat")),
+    m_rates(new CounterRates(CPU_STAT_KEYS_NUMBER))
+{
+}
+
+CgroupMonitor::~CgroupMonitor()
+{
+}
+
+const std::string& CgroupMonitor::directory() const
+{
+    return m_dir;
+}
+
+std::string CgroupMonitor::findCgroupDirectory()
+{
+    // With cgroup v2, /proc/self/cgroup holds a single '0::<path>' line
+    std::ifstream cgroup(SystemRoot::path("/proc/self/cgroup"));
+    std::string line;
+    while (std::getline(cgroup, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            std::string path = line.substr(3);
+            return SystemRoot::path(CGROUP_ROOT) + (path == "/" ? "" : path);
+        }
+    }
+    return "";
+}
+
+MetricSchema CgroupMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "cgroup";
+    schema.fields = {"cpu_usage", "throttled", "throttled_ms_s", "mem_current", "mem_max", "mem_anon", "mem_file"};
+    return schema;
+}
+
+void CgroupMonitor::sample(double* values)
+{
+    // cpu.stat dumps the following info:
+    // usage_usec 2377373
+    // user_usec 1618163
+    // system_usec 759209
+    // nr_periods 1000
+    // nr_throttled 12
+    // throttled_usec 42000
+    unsigned long long cpuStats[CPU_STAT_KEYS_NUMBER] = {0};
+    parseKeyedFile(m_cpuStat->read(), CPU_STAT_KEYS, CPU_STAT_KEYS_NUMBER, cpuStats);
+    double rates[CPU_STAT_KEYS_NUMBER];
+    m_rates->update(cpuStats, rates);
+    values[0] = rates[0] / 10000.; // us per second to percentage
+    values[1] = rates[1] > 0. ? 100. * rates[2] / rates[1] : 0.;
+    values[2] = rates[3] / 1000.;
+
+    // memory.current and memory.max hold a single value in bytes ('max' if unlimited)
+    unsigned long long current = 0, max = 0;
+    const char* content = m_memoryCurrent->read();
+    if (content) {
+        ProcFile::parseNumber(content, current);
+    }
+    content = m_memoryMax->read();
+    if (content) {
+        ProcFile::parseNumber(content, max);
+    }
+    static const char* const MEMORY_STAT_KEYS[] = {"anon", "file"};
+    unsigned long long memoryStats[2] = {0};
+    parseKeyedFile(m_memoryStat->read(), MEMORY_STAT_KEYS, 2, memoryStats);
+
+    values[3] = current / 1024;
+    values[4] = max / 1024;
+    values[5] = memoryStats[0] / 1024;
+    values[6] = memoryStats[1] / 1024;
+}
+
+}
@@ -0,0 +1,58 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef CGROUPMONITOR_H_
+#define CGROUPMONITOR_H_
+
+#include "api.h"
+#include "imetricmonitor.h"
+#include <memory>
+#include <string>
+
+namespace uprofile
+{
+class CounterRates;
+class ProcFile;
+
+/**
+ * Monitor of the CPU and memory of the cgroup v2 of the process (e.g. a container)
+ *
+ * Records 'cgroup' events with:
+ * - cpu_usage: CPU used by the cgroup (in % of one CPU)
+ * - throttled: percentage of the CFS periods during which the cgroup was throttled
+ * - throttled_ms_s: time spent throttled (in ms per second)
+ * - mem_current, mem_max, mem_anon, mem_file: memory usage, limit (0 if unlimited),
+ *   anonymous and page cache memory (in KiB)
+ */
+class CgroupMonitor : public IMetricMonitor
+{
+public:
+    // cgroupDir is the cgroup directory, by default the one of the process read from /proc/self/cgroup
+    UPROFAPI explicit CgroupMonitor(const std::string& cgroupDir = "");
+    UPROFAPI virtual ~CgroupMonitor();
+
+    // Return the monitored cgroup directory, empty if the process is not in a cgroup v2 hierarchy
+    UPROFAPI const std::string& directory() const;
+
+    UPROFAPI MetricSchema schema() const override;
+    UPROFAPI void sample(double* values) override;
+
+private:
+    static std::string findCgroupDirectory();
+
+    std::string m_dir;
+    std::unique_ptr<ProcFile> m_cpuStat;
+    std::unique_ptr<ProcFile> m_memoryCurrent;
+    std::unique_ptr<ProcFile> m_memoryMax;
+    std::unique_ptr<ProcFile> m_memoryStat;
+    std::unique_ptr<CounterRates> m_rates;
+};
+
+}
+#endif /* CGROUPMONITOR_H_ */
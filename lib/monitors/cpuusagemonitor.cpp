@@ -0,0 +1,57 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "cpuusagemonitor.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace uprofile
+{
+
+CpuUsageMonitor::CpuUsageMonitor(bool affinityOnly) :
+    m_usages(m_cpuMonitor.getNumberOfCpus(), 0)
+{
+#if defined(__linux__)
+    cpu_set_t affinity;
+    if (affinityOnly && sched_getaffinity(0, sizeof(affinity), &affinity) != 0) {
+        affinityOnly = false;
+    }
+#endif
+    for (size_t index = 0; index < m_usages.size(); ++index) {
+#if defined(__linux__)
+        if (affinityOnly && !CPU_ISSET(index, &affinity)) {
+            continue;
+        }
+#endif
+        m_cpus.push_back(index);
+    }
+}
+
+MetricSchema CpuUsageMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "cpu";
+    for (size_t i = 0; i < m_cpus.size(); ++i) {
+        schema.instances.push_back(std::to_string(m_cpus[i]));
+    }
+    schema.fields = {"usage"};
+    return schema;
+}
+
+void CpuUsageMonitor::sample(double* values)
+{
+    m_cpuMonitor.getUsage(m_usages);
+    for (size_t i = 0; i < m_cpus.size(); ++i) {
+        values[i] = m_usages[m_cpus[i]];
+    }
+}
+
+}
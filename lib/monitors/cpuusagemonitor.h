@@ -0,0 +1,38 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef CPUUSAGEMONITOR_H_
+#define CPUUSAGEMONITOR_H_
+
+#include "imetricmonitor.h"
+#include "util/cpumonitor.h"
+
+namespace uprofile
+{
+
+// Usage (in percentage) of each CPU core
+class CpuUsageMonitor : public IMetricMonitor
+{
+public:
+    // affinityOnly restricts the monitoring to the cores the process can run on
+    // (its affinity mask, which also reflects its cgroup cpuset)
+    explicit CpuUsageMonitor(bool affinityOnly = false);
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    CpuMonitor m_cpuMonitor;
+    vector<float> m_usages;
+    vector<size_t> m_cpus; // monitored cores
+};
+
+}
+
+#endif /* CPUUSAGEMONITOR_H_ */
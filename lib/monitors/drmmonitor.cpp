@@ -0,0 +1,133 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "drmmonitor.h"
+#include "util/procfile.h"
+#include "util/systemroot.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <dirent.h>
+#endif
+
+namespace uprofile
+{
+
+struct DrmMonitor::Card {
+    std::string name;
+    int index;
+    std::unique_ptr<ProcFile> busy;      // %
+    std::unique_ptr<ProcFile> vramUsed;  // bytes
+    std::unique_ptr<ProcFile> vramTotal; // bytes
+};
+
+// Return the number read from the file, 0 if it cannot be read
+static unsigned long long readNumber(ProcFile& file)
+{
+    unsigned long long value = 0;
+    const char* content = file.isOpen() ? file.read() : nullptr;
+    if (content) {
+        ProcFile::parseNumber(ProcFile::skipSpaces(content), value);
+    }
+    return value;
+}
+
+DrmMonitor::DrmMonitor(const std::string& directory)
+{
+#if defined(__linux__)
+    const std::string drmDir = directory.empty() ? SystemRoot::path("/sys/class/drm") : directory;
+    DIR* dir = opendir(drmDir.c_str());
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        // Only the cards, not their connectors (e.g. 'card0-HDMI-A-1') nor the render nodes
+        const char* name = entry->d_name;
+        if (strncmp(name, "card", 4) != 0 || name[4] == '\0' || strspn(name + 4, "0123456789") != strlen(name + 4)) {
+            continue;
+        }
+        const std::string deviceDir = drmDir + "/" + name + "/device/";
+        std::unique_ptr<Card> card(new Card);
+        card->name = name;
+        card->index = atoi(name + 4);
+        card->busy.reset(new ProcFile(deviceDir + "gpu_busy_percent"));
+        card->vramUsed.reset(new ProcFile(deviceDir + "mem_info_vram_used"));
+        card->vramTotal.reset(new ProcFile(deviceDir + "mem_info_vram_total"));
+        // Cards whose driver exposes none of the metrics are ignored
+        if (card->busy->isOpen() || card->vramTotal->isOpen()) {
+            m_cards.push_back(std::move(card));
+        }
+    }
+    closedir(dir);
+    std::sort(m_cards.begin(), m_cards.end(), [](const std::unique_ptr<Card>& a, const std::unique_ptr<Card>& b) {
+        return a->index < b->index;
+    });
+#else
+    (void)directory;
+#endif
+    m_usages.resize(m_cards.size(), 0.f);
+}
+
+DrmMonitor::~DrmMonitor()
+{
+}
+
+void DrmMonitor::start(int /*period*/)
+{
+    // Files are read when the metrics are dumped
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_watching = !m_cards.empty();
+}
+
+void DrmMonitor::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_watching = false;
+}
+
+bool DrmMonitor::watching() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_watching;
+}
+
+const std::vector<float>& DrmMonitor::getUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_cards.size(); ++i) {
+        m_usages[i] = static_cast<float>(readNumber(*m_cards[i]->busy));
+    }
+    return m_usages;
+}
+
+void DrmMonitor::getMemory(std::vector<int>& usedMem, std::vector<int>& totalMem) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    usedMem.resize(m_cards.size());
+    totalMem.resize(m_cards.size());
+    for (size_t i = 0; i < m_cards.size(); ++i) {
+        // Bytes to KiB
+        usedMem[i] = static_cast<int>(readNumber(*m_cards[i]->vramUsed) / 1024);
+        totalMem[i] = static_cast<int>(readNumber(*m_cards[i]->vramTotal) / 1024);
+    }
+}
+
+std::vector<std::string> DrmMonitor::getNames() const
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < m_cards.size(); ++i) {
+        names.push_back(m_cards[i]->name);
+    }
+    return names;
+}
+
+}
@@ -0,0 +1,55 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef DRMMONITOR_H_
+#define DRMMONITOR_H_
+
+#include "api.h"
+#include "igpumonitor.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Monitor of the GPUs exposed by the kernel DRM drivers through sysfs
+ *
+ * Reads the busy percentage (gpu_busy_percent) and the VRAM usage (mem_info_vram_used
+ * and mem_info_vram_total) of each 'card<N>' device, as exposed by amdgpu for instance.
+ * Files are kept opened and read when the metrics are dumped: no thread nor child process
+ * is needed. GPUs are labelled with their card name.
+ */
+class DrmMonitor : public IGPUMonitor
+{
+public:
+    // drmDir holds the 'card<N>' devices, by default /sys/class/drm
+    UPROFAPI explicit DrmMonitor(const std::string& drmDir = "");
+    UPROFAPI virtual ~DrmMonitor();
+
+    UPROFAPI void start(int period) override;
+    UPROFAPI void stop() override;
+    UPROFAPI bool watching() const override;
+    UPROFAPI const std::vector<float>& getUsage() const override;
+    UPROFAPI void getMemory(std::vector<int>& usedMem, std::vector<int>& totalMem) const override;
+    UPROFAPI std::vector<std::string> getNames() const override;
+
+private:
+    struct Card;
+
+    mutable std::mutex m_mutex;
+    bool m_watching = false;
+    std::vector<std::unique_ptr<Card>> m_cards;
+    mutable std::vector<float> m_usages;
+};
+
+}
+#endif /* DRMMONITOR_H_ */
@@ -0,0 +1,220 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "iomonitors.h"
+#include "util/systemroot.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+static const char* const PROC_IO_KEYS[] = {"read_bytes", "write_bytes", "rchar", "wchar", "syscr", "syscw"};
+static const size_t PROC_IO_FIELDS_NUMBER = 6;
+static const size_t DISK_IO_FIELDS_NUMBER = 5;
+static const size_t NET_IO_FIELDS_NUMBER = 6;
+
+// Return the index of the name of 'length' characters in names, -1 if not found
+static int findName(const std::vector<std::string>& names, const char* name, size_t length)
+{
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i].size() == length && strncmp(names[i].c_str(), name, length) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+ProcessIOMonitor::ProcessIOMonitor() :
+    m_file(SystemRoot::path("/proc/self/io")),
+    m_rates(PROC_IO_FIELDS_NUMBER)
+{
+}
+
+MetricSchema ProcessIOMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "proc_io";
+    schema.fields = {"read_kb_s", "write_kb_s", "rchar_kb_s", "wchar_kb_s", "syscr_s", "syscw_s"};
+    return schema;
+}
+
+void ProcessIOMonitor::sample(double* values)
+{
+    // /proc/self/io dumps the following info:
+    // rchar: 323934931
+    // wchar: 323929600
+    // syscr: 632687
+    // syscw: 632675
+    // read_bytes: 0
+    // write_bytes: 323932160
+    // cancelled_write_bytes: 0
+    unsigned long long counters[PROC_IO_FIELDS_NUMBER] = {0};
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        size_t length = ProcFile::wordLength(pos);
+        for (size_t i = 0; i < PROC_IO_FIELDS_NUMBER; ++i) {
+            if (strlen(PROC_IO_KEYS[i]) == length && strncmp(PROC_IO_KEYS[i], pos, length) == 0) {
+                ProcFile::parseNumber(pos + length + 1, counters[i]);
+                break;
+            }
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+
+    m_rates.update(counters, values);
+    // Bytes to KiB
+    for (size_t i = 0; i < 4; ++i) {
+        values[i] /= 1024.;
+    }
+}
+
+DiskIOMonitor::DiskIOMonitor() :
+    m_file(SystemRoot::path("/proc/diskstats")),
+    m_rates(0)
+{
+    // Only keep the whole devices (not their partitions) which are listed in /sys/block
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        unsigned long long number = 0;
+        pos = ProcFile::parseNumber(pos, number); // major
+        pos = ProcFile::parseNumber(pos, number); // minor
+        pos = ProcFile::skipSpaces(pos);
+        std::string name(pos, ProcFile::wordLength(pos));
+        bool virtualDevice = name.compare(0, 4, "loop") == 0 || name.compare(0, 3, "ram") == 0;
+#if defined(__linux__)
+        if (!name.empty() && !virtualDevice && access(SystemRoot::path("/sys/block/" + name).c_str(), F_OK) == 0) {
+            m_disks.push_back(name);
+        }
+#endif
+        pos = ProcFile::nextLine(pos);
+    }
+    m_counters.resize(m_disks.size() * DISK_IO_FIELDS_NUMBER, 0);
+    m_rates = CounterRates(m_counters.size());
+}
+
+MetricSchema DiskIOMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "disk_io";
+    schema.instances = m_disks;
+    schema.fields = {"read_kb_s", "write_kb_s", "read_iops", "write_iops", "util"};
+    return schema;
+}
+
+void DiskIOMonitor::sample(double* values)
+{
+    // /proc/diskstats dumps the following info:
+    //          major minor name reads merged sectors ms writes merged sectors ms in_progress io_ms ...
+    //   259       0 nvme0n1 169267 41837 13458386 30412 413339 264329 22516168 312476 0 288168 ...
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        unsigned long long stats[10] = {0};
+        pos = ProcFile::parseNumber(pos, stats[0]); // major
+        pos = ProcFile::parseNumber(pos, stats[0]); // minor
+        pos = ProcFile::skipSpaces(pos);
+        size_t length = ProcFile::wordLength(pos);
+        int index = findName(m_disks, pos, length);
+        if (index >= 0) {
+            pos += length;
+            for (size_t i = 0; i < 10; ++i) {
+                pos = ProcFile::parseNumber(pos, stats[i]);
+            }
+            unsigned long long* counters = &m_counters[index * DISK_IO_FIELDS_NUMBER];
+            counters[0] = stats[2]; // sectors read
+            counters[1] = stats[6]; // sectors written
+            counters[2] = stats[0]; // reads completed
+            counters[3] = stats[4]; // writes completed
+            counters[4] = stats[9]; // time spent doing I/Os (ms)
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+
+    if (m_counters.empty()) {
+        return;
+    }
+    m_rates.update(&m_counters[0], values);
+    for (size_t i = 0; i < m_disks.size(); ++i) {
+        double* diskValues = &values[i * DISK_IO_FIELDS_NUMBER];
+        // Sectors are always 512 bytes
+        diskValues[0] /= 2.;
+        diskValues[1] /= 2.;
+        // Busy ms per second to percentage
+        diskValues[4] /= 10.;
+    }
+}
+
+NetworkIOMonitor::NetworkIOMonitor() :
+    m_file(SystemRoot::path("/proc/net/dev")),
+    m_rates(0)
+{
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        pos = ProcFile::skipSpaces(pos);
+        size_t length = ProcFile::wordLength(pos);
+        if (pos[length] == ':') {
+            m_interfaces.push_back(std::string(pos, length));
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+    m_counters.resize(m_interfaces.size() * NET_IO_FIELDS_NUMBER, 0);
+    m_rates = CounterRates(m_counters.size());
+}
+
+MetricSchema NetworkIOMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "net_io";
+    schema.instances = m_interfaces;
+    schema.fields = {"rx_kb_s", "tx_kb_s", "rx_packets_s", "tx_packets_s", "rx_drops_s", "tx_drops_s"};
+    return schema;
+}
+
+void NetworkIOMonitor::sample(double* values)
+{
+    // /proc/net/dev dumps the following info (after two header lines):
+    //  face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop ...
+    //  eth0: 1215645   2751    0    0    0     0          0         0  1782404   4324    0    0 ...
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        pos = ProcFile::skipSpaces(pos);
+        size_t length = ProcFile::wordLength(pos);
+        int index = pos[length] == ':' ? findName(m_interfaces, pos, length) : -1;
+        if (index >= 0) {
+            unsigned long long stats[12] = {0};
+            pos += length + 1;
+            for (size_t i = 0; i < 12; ++i) {
+                pos = ProcFile::parseNumber(pos, stats[i]);
+            }
+            unsigned long long* counters = &m_counters[index * NET_IO_FIELDS_NUMBER];
+            counters[0] = stats[0];  // received bytes
+            counters[1] = stats[8];  // transmitted bytes
+            counters[2] = stats[1];  // received packets
+            counters[3] = stats[9];  // transmitted packets
+            counters[4] = stats[3];  // received drops
+            counters[5] = stats[11]; // transmitted drops
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+
+    if (m_counters.empty()) {
+        return;
+    }
+    m_rates.update(&m_counters[0], values);
+    for (size_t i = 0; i < m_interfaces.size(); ++i) {
+        values[i * NET_IO_FIELDS_NUMBER] /= 1024.;
+        values[i * NET_IO_FIELDS_NUMBER + 1] /= 1024.;
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef IOMONITORS_H_
+#define IOMONITORS_H_
+
+#include "imetricmonitor.h"
+#include "util/counterrates.h"
+#include "util/procfile.h"
+
+namespace uprofile
+{
+
+// I/O of the current process (/proc/self/io) in KiB/s and syscalls/s
+class ProcessIOMonitor : public IMetricMonitor
+{
+public:
+    ProcessIOMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    ProcFile m_file;
+    CounterRates m_rates;
+};
+
+// Throughput (KiB/s), IOPS and utilization (%) of each block device (/proc/diskstats)
+class DiskIOMonitor : public IMetricMonitor
+{
+public:
+    DiskIOMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    ProcFile m_file;
+    std::vector<std::string> m_disks;
+    std::vector<unsigned long long> m_counters;
+    CounterRates m_rates;
+};
+
+// Throughput (KiB/s), packets/s and drops/s of each network interface (/proc/net/dev)
+class NetworkIOMonitor : public IMetricMonitor
+{
+public:
+    NetworkIOMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    ProcFile m_file;
+    std::vector<std::string> m_interfaces;
+    std::vector<unsigned long long> m_counters;
+    CounterRates m_rates;
+};
+
+}
+
+#endif /* IOMONITORS_H_ */
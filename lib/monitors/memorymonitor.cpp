@@ -0,0 +1,100 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "memorymonitor.h"
+#include "util/systemroot.h"
+
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace uprofile
+{
+
+MetricSchema ProcessMemoryMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "proc_mem";
+    schema.fields = {"rss", "shared"};
+    return schema;
+}
+
+void ProcessMemoryMonitor::sample(double* values)
+{
+    int rss = 0, shared = 0;
+    read(rss, shared);
+    values[0] = rss;
+    values[1] = shared;
+}
+
+void ProcessMemoryMonitor::read(int& rss, int& shared)
+{
+#if defined(__linux__)
+    int tSize = 0, resident = 0, share = 0;
+    ifstream buffer(SystemRoot::path("/proc/self/statm"));
+    buffer >> tSize >> resident >> share;
+    buffer.close();
+
+    long page_size_kb = getpagesize() / 1024;
+    rss = resident * page_size_kb;
+    shared = share * page_size_kb;
+#endif
+}
+
+MetricSchema SystemMemoryMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "sys_mem";
+    schema.fields = {"total", "available", "free"};
+    return schema;
+}
+
+void SystemMemoryMonitor::sample(double* values)
+{
+    int total = 0, available = 0, free = 0;
+    read(total, available, free);
+    values[0] = total;
+    values[1] = available;
+    values[2] = free;
+}
+
+void SystemMemoryMonitor::read(int& totalMem, int& availableMem, int& freeMem)
+{
+#if defined(__linux__)
+    // /proc/meminfo returns the dump here:
+    // MemTotal: 515164 kB
+    // MemFree: 7348 kB
+    // MemAvailable: 7348 kB
+    ifstream meminfo(SystemRoot::path("/proc/meminfo"));
+    string line;
+    while (std::getline(meminfo, line)) {
+        if (line.find("MemTotal") != std::string::npos) {
+            stringstream ls(line);
+            ls.ignore(256, ' ');
+            ls >> totalMem;
+        } else if (line.find("MemFree") != std::string::npos) {
+            stringstream ls(line);
+            ls.ignore(256, ' ');
+            ls >> freeMem;
+        } else if (line.find("MemAvailable") != std::string::npos) {
+            stringstream ls(line);
+            ls.ignore(256, ' ');
+            ls >> availableMem;
+            break;
+        }
+    }
+#endif
+}
+
+}
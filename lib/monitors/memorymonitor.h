@@ -0,0 +1,40 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef MEMORYMONITOR_H_
+#define MEMORYMONITOR_H_
+
+#include "imetricmonitor.h"
+
+namespace uprofile
+{
+
+// Resident and shared memory (in KiB) of the current process
+class ProcessMemoryMonitor : public IMetricMonitor
+{
+public:
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+    static void read(int& rss, int& shared);
+};
+
+// Total, available and free system memory (in KiB)
+class SystemMemoryMonitor : public IMetricMonitor
+{
+public:
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+    static void read(int& totalMem, int& availableMem, int& freeMem);
+};
+
+}
+
+#endif /* MEMORYMONITOR_H_ */
@@ -8,76 +8,58 @@
 // Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
 
 #include "nvidiamonitor.h"
+#include "util/procfile.h"
 
 #include <algorithm>
 #include <errno.h>
-#include <fcntl.h>
 #include <iostream>
-#include <sstream>
 #include <string.h>
 
 #if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
-#include <memory>
 
 using namespace std;
 
-const string nvidiaSmiCmdName = "/usr/bin/nvidia-smi";
 const string errorMsg = "Failed to monitor nvidia-smi process";
 
-struct RawMetric {
-    string index;
-    string usage;
-    string usedMem;
-    string totalMem;
-};
+// Size of the buffer of the line being read, longer lines are dropped
+static const size_t LINE_BUFFER_SIZE = 4096;
+// Delay before restarting nvidia-smi after a failure (in ms)
+static const int RESTART_DELAY = 500;
+// Time given to nvidia-smi to exit before being killed (in ms)
+static const int TERMINATE_TIMEOUT = 500;
 
 #if defined(__linux__)
-int read_nvidia_smi_stdout(int fd, vector<RawMetric>& metrics)
-{
-    size_t nbCollected = 0;
-    while (nbCollected < metrics.size()) {
-        string line;
-
-        // nvidia-smi dumps metrics for each GPU line by line
-        // so read the stdout line by line and fill the input metrics buffer
-        while (line.find('\n') == string::npos) { // full line read
-            char buffer[4096];
-            ssize_t count = read(fd, buffer, sizeof(buffer)); // if child process crashes, we gonna be blocked here forever
-            if (count == -1) {
-                return errno;
-            } else if (count > 0) { // there is something to read
-                line += string(buffer, count);
-            }
-        }
-
-        // Remove colon to have only spaces and use istringstream
-        auto noSpaceEnd = remove(line.begin(), line.end(), ',');
-        if (noSpaceEnd == line.end()) { // output trace does not have comma so something went wrong with the command
-            return ENODATA;
-        }
-        line.erase(noSpaceEnd, line.end());
-        istringstream ss(line);
-        RawMetric metric;
-        ss >> metric.index >> metric.usage >> metric.usedMem >> metric.totalMem;
-        metrics[nbCollected] = metric;
-        nbCollected++;
+// Parse a field of a CSV line, fields not holding a number (like '[N/A]') are 0.
+// Return the position following the field separator, nullptr for the last field
+static const char* parseField(const char* pos, double& value, bool& numeric)
+{
+    pos = uprofile::ProcFile::skipSpaces(pos);
+    numeric = *pos >= '0' && *pos <= '9';
+    value = 0.;
+    if (numeric) {
+        pos = uprofile::ProcFile::parseDecimal(pos, value);
     }
-
-    return 0;
+    const char* separator = strchr(pos, ',');
+    return separator ? separator + 1 : nullptr;
 }
 #endif
 
-uprofile::NvidiaMonitor::NvidiaMonitor()
+uprofile::NvidiaMonitor::NvidiaMonitor(const string& command) :
+    m_command(command),
+    m_line(LINE_BUFFER_SIZE)
 {
     // Place nvidia-smi command to retrieve number of GPUs
     // to initialize usage and memsvectors
     try {
         char buffer[128];
         string result = "";
-        string cmd = nvidiaSmiCmdName;
+        string cmd = m_command;
         cmd += " --query-gpu=count --format=csv,noheader,nounits";
         FILE* pipe = popen(cmd.c_str(), "r");
         if (!pipe) {
@@ -127,73 +109,29 @@ void uprofile::NvidiaMonitor::getMemory(std::vector<int>& usedMem, std::vector<i
 
 void uprofile::NvidiaMonitor::watchGPU(int period)
 {
-    if (m_watching) {
+    if (m_watcherThread) {
         return;
     }
 
 #if defined(__linux__)
-    char* args[5];
-    args[0] = (char*)"/usr/bin/nvidia-smi";
-    string period_arg = "-lms=" + to_string(period); // lms stands for continuous watching
-    args[1] = (char*)period_arg.c_str();
-    args[2] = (char*)"--query-gpu=index,utilization.gpu,memory.used,memory.total";
-    args[3] = (char*)"--format=csv,noheader,nounits";
-    args[4] = NULL;
-    string output;
-    int pipes[2];
-
-    // Create the pipe
-    if (pipe(pipes) == -1) {
-        cerr << errorMsg << ": pipe creation failed" << endl;
+    if (m_nbGPUs == 0) {
+        cerr << errorMsg << ": no GPU found" << endl;
         return;
     }
-
-    // Create a child process for calling nvidia-smi
-    pid_t pid = fork();
-
-    switch (pid) {
-    case -1: /* Error */
-        cerr << errorMsg << ": process fork failed" << endl;
+    if (pipe2(m_wakeupFds, O_CLOEXEC) == -1) {
+        cerr << errorMsg << ": pipe creation failed" << endl;
         return;
-    case 0: /* We are in the child process */
-        while ((dup2(pipes[1], STDOUT_FILENO) == -1) && (errno == EINTR)) {
-        }
-        close(pipes[1]);
-        close(pipes[0]);
-        execv(args[0], args);
-        cerr << "Failed to execute '" << args[0] << "': " << strerror(errno) << endl; /* execl doesn't return unless there's an error */
-        exit(1);
-    default: /* We are in the parent process */
-        int stdout_fd = pipes[0];
-
-        // Start a thread to retrieve the child process stdout
-        m_watching = true;
-        m_watcherThread = unique_ptr<std::thread>(new thread([stdout_fd, pid, this]() {
-            while (watching()) {
-                vector<RawMetric> metrics(m_nbGPUs);
-                // if the child process crashes, an error is raised here and threads ends up
-                int err = read_nvidia_smi_stdout(stdout_fd, metrics);
-                if (err != 0) {
-                    cerr << errorMsg << ": read_error = " << strerror(err) << endl;
-                    unique_lock<mutex> lk(m_mutex);
-                    m_watching = false;
-                    lk.unlock();
-                    break;
-                }
-
-                unique_lock<mutex> lk(m_mutex);
-                for (size_t i = 0; i < metrics.size(); ++i) {
-                    const auto& m = metrics[i];
-                    size_t idx = stoull(m.index);
-                    m_gpuUsages[idx] = !m.usage.empty() ? stof(m.usage) : 0.f;
-                    m_usedMems[idx] = !m.usedMem.empty() ? stoi(m.usedMem) * 1024 : 0;    // MiB to KiB
-                    m_totalMems[idx] = !m.totalMem.empty() ? stoi(m.totalMem) * 1024 : 0; // MiB to KiB
-                }
-                lk.unlock();
-            }
-        }));
     }
+
+    // Start a thread running nvidia-smi and reading its stdout
+    unique_lock<mutex> lk(m_mutex);
+    m_watching = true;
+    lk.unlock();
+    m_watcherThread = unique_ptr<std::thread>(new thread([this, period]() {
+        watch(period);
+    }));
 #else
+    (void)period;
     cerr << errorMsg << endl;
 #endif
 }
@@ -205,8 +143,15 @@ void uprofile::NvidiaMonitor::abortWatchGPU()
         unique_lock<mutex> lk(m_mutex);
         m_watching = false;
         lk.unlock();
+        // Wake the watcher thread up, it may be waiting for nvidia-smi output
+        char wakeup = 0;
+        while (write(m_wakeupFds[1], &wakeup, 1) == -1 && errno == EINTR) {
+        }
         m_watcherThread->join();
         m_watcherThread.reset();
+        close(m_wakeupFds[0]);
+        close(m_wakeupFds[1]);
+        m_wakeupFds[0] = m_wakeupFds[1] = -1;
     }
 #endif
 }
@@ -216,3 +161,156 @@ bool uprofile::NvidiaMonitor::watching() const
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_watching;
 }
+
+#if defined(__linux__)
+void uprofile::NvidiaMonitor::watch(int period)
+{
+    // nvidia-smi is considered hung when it dumps nothing during 10 periods
+    const int timeout = std::max(10 * period, 1000);
+    while (watching()) {
+        if (spawn(period)) {
+            while (readOutput(timeout)) {
+            }
+            terminate();
+        }
+        if (!waitStop(RESTART_DELAY)) {
+            cerr << errorMsg << ": restarting '" << m_command << "'" << endl;
+        }
+    }
+}
+
+bool uprofile::NvidiaMonitor::spawn(int period)
+{
+    string periodArg = "-lms=" + to_string(period); // lms stands for continuous watching
+    const char* args[] = {m_command.c_str(), periodArg.c_str(), "--query-gpu=index,utilization.gpu,memory.used,memory.total",
+                          "--format=csv,noheader,nounits", NULL};
+    int pipes[2];
+
+    // Create the pipe
+    if (pipe2(pipes, O_CLOEXEC) == -1) {
+        cerr << errorMsg << ": pipe creation failed" << endl;
+        return false;
+    }
+
+    // Create a child process for calling nvidia-smi
+    pid_t pid = fork();
+
+    switch (pid) {
+    case -1: /* Error */
+        cerr << errorMsg << ": process fork failed" << endl;
+        close(pipes[0]);
+        close(pipes[1]);
+        return false;
+    case 0: /* We are in the child process */
+        // Own process group, killed as a whole with the processes nvidia-smi (or a wrapper script) may spawn
+        setpgid(0, 0);
+        while ((dup2(pipes[1], STDOUT_FILENO) == -1) && (errno == EINTR)) {
+        }
+        execv(args[0], const_cast<char* const*>(args));
+        _exit(127); /* execv doesn't return unless there's an error, reported by the parent */
+    default:        /* We are in the parent process */
+        setpgid(pid, pid);
+        close(pipes[1]);
+        m_pid = pid;
+        m_stdoutFd = pipes[0];
+        m_lineSize = 0;
+        return true;
+    }
+}
+
+bool uprofile::NvidiaMonitor::readOutput(int timeout)
+{
+    struct pollfd fds[2] = {{m_stdoutFd, POLLIN, 0}, {m_wakeupFds[0], POLLIN, 0}};
+    int ready = poll(fds, 2, timeout);
+    if (ready == -1) {
+        return errno == EINTR;
+    }
+    if (ready == 0) {
+        cerr << errorMsg << ": no output for " << timeout << " ms" << endl;
+        return false;
+    }
+    if (fds[1].revents != 0) {
+        // Monitor stopped
+        return false;
+    }
+
+    ssize_t count = read(m_stdoutFd, &m_line[m_lineSize], m_line.size() - m_lineSize - 1);
+    if (count == -1) {
+        return errno == EINTR;
+    }
+    if (count == 0) {
+        // nvidia-smi exited
+        return false;
+    }
+    m_lineSize += count;
+
+    // nvidia-smi dumps metrics for each GPU line by line: parse the complete
+    // lines and keep the partial one at the beginning of the buffer
+    char* begin = &m_line[0];
+    char* end = begin + m_lineSize;
+    for (char* eol; (eol = static_cast<char*>(memchr(begin, '\n', end - begin))) != nullptr; begin = eol + 1) {
+        *eol = '\0';
+        parseLine(begin);
+    }
+    m_lineSize = end - begin;
+    if (m_lineSize + 1 == m_line.size()) {
+        // Not a metrics line
+        m_lineSize = 0;
+    } else {
+        memmove(&m_line[0], begin, m_lineSize);
+    }
+    return true;
+}
+
+void uprofile::NvidiaMonitor::parseLine(const char* line)
+{
+    // Each line holds the index, usage (%), used and total memory (MiB) of a GPU, the metrics
+    // the GPU does not support being '[N/A]' (e.g. '0, 35, 1024, 8192' or '1, [N/A], 512, 4096')
+    double values[4];
+    bool numeric[4];
+    const char* pos = line;
+    for (size_t i = 0; i < 4; ++i) {
+        if (!pos) {
+            return;
+        }
+        pos = parseField(pos, values[i], numeric[i]);
+    }
+    size_t index = static_cast<size_t>(values[0]);
+    if (!numeric[0] || index >= m_nbGPUs) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gpuUsages[index] = static_cast<float>(values[1]);
+    m_usedMems[index] = static_cast<int>(values[2]) * 1024;  // MiB to KiB
+    m_totalMems[index] = static_cast<int>(values[3]) * 1024; // MiB to KiB
+}
+
+void uprofile::NvidiaMonitor::terminate()
+{
+    close(m_stdoutFd);
+    m_stdoutFd = -1;
+
+    // nvidia-smi is asked to exit then killed if it does not
+    kill(-m_pid, SIGTERM);
+    int status = 0;
+    pid_t result = 0;
+    for (int waited = 0; (result = waitpid(m_pid, &status, WNOHANG)) == 0 && waited < TERMINATE_TIMEOUT; waited += 10) {
+        usleep(10000);
+    }
+    if (result == 0) {
+        kill(-m_pid, SIGKILL);
+        result = waitpid(m_pid, &status, 0);
+    }
+    if (result == m_pid && WIFEXITED(status) && WEXITSTATUS(status) == 127) {
+        cerr << errorMsg << ": cannot execute '" << m_command << "'" << endl;
+    }
+    m_pid = -1;
+}
+
+bool uprofile::NvidiaMonitor::waitStop(int timeout)
+{
+    struct pollfd fd = {m_wakeupFds[0], POLLIN, 0};
+    return poll(&fd, 1, timeout) > 0;
+}
+#endif
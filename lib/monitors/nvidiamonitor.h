@@ -12,6 +12,7 @@
 
 #include "api.h"
 #include "igpumonitor.h"
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -19,10 +20,19 @@
 
 namespace uprofile
 {
+
+/**
+ * Monitor of the NVidia GPUs through nvidia-smi
+ *
+ * nvidia-smi runs in a child process dumping the metrics of each GPU every period. Its
+ * output is read by a thread with timeouts: if nvidia-smi exits, fails or stops dumping
+ * metrics, it is killed and started again until the monitor is stopped.
+ */
 class NvidiaMonitor : public IGPUMonitor
 {
 public:
-    UPROFAPI explicit NvidiaMonitor();
+    // command is the nvidia-smi executable
+    UPROFAPI explicit NvidiaMonitor(const std::string& command = "/usr/bin/nvidia-smi");
     UPROFAPI virtual ~NvidiaMonitor();
 
     UPROFAPI void start(int period) override;
@@ -35,9 +45,23 @@ private:
     void watchGPU(int period);
     void abortWatchGPU();
 
+    // Watcher thread: run nvidia-smi and read its output until the monitor is stopped
+    void watch(int period);
+    bool spawn(int period);
+    bool readOutput(int timeout); // false when nvidia-smi has to be restarted
+    void parseLine(const char* line);
+    void terminate();
+    bool waitStop(int timeout); // true if the monitor was stopped during the timeout (in ms)
+
+    const std::string m_command;
     mutable std::mutex m_mutex;
     std::unique_ptr<std::thread> m_watcherThread;
     bool m_watching = false;
+    int m_wakeupFds[2] = {-1, -1}; // written on stop to wake the watcher thread up
+    int m_pid = -1;                // nvidia-smi process
+    int m_stdoutFd = -1;
+    std::vector<char> m_line; // line being read from nvidia-smi output
+    size_t m_lineSize = 0;
     std::vector<int> m_totalMems;
     std::vector<int> m_usedMems;
     std::vector<float> m_gpuUsages;
@@ -0,0 +1,79 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "pressuremonitor.h"
+#include "util/procfile.h"
+#include "util/systemroot.h"
+
+#include <cstring>
+
+namespace uprofile
+{
+
+static const char* const RESOURCES[] = {"cpu", "memory", "io"};
+static const size_t PSI_FIELDS_NUMBER = 6;
+
+PressureMonitor::PressureMonitor(const std::string& directory)
+{
+    const std::string pressureDir = directory.empty() ? SystemRoot::path("/proc/pressure") : directory;
+    // Only keep the resources with pressure information (PSI may be disabled in the kernel)
+    for (size_t i = 0; i < sizeof(RESOURCES) / sizeof(RESOURCES[0]); ++i) {
+        std::unique_ptr<ProcFile> file(new ProcFile(pressureDir + "/" + RESOURCES[i]));
+        if (!file->isOpen()) {
+            file.reset(new ProcFile(pressureDir + "/" + RESOURCES[i] + ".pressure"));
+        }
+        if (file->isOpen()) {
+            m_resources.push_back(RESOURCES[i]);
+            m_files.push_back(std::move(file));
+        }
+    }
+}
+
+PressureMonitor::~PressureMonitor()
+{
+}
+
+MetricSchema PressureMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "psi";
+    schema.instances = m_resources;
+    schema.fields = {"some_avg10", "some_avg60", "some_avg300", "full_avg10", "full_avg60", "full_avg300"};
+    return schema;
+}
+
+void PressureMonitor::sample(double* values)
+{
+    // Pressure files dump the following info:
+    // some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+    // full avg10=0.00 avg60=0.00 avg300=0.00 total=4567
+    for (size_t i = 0; i < m_files.size(); ++i) {
+        double* resourceValues = &values[i * PSI_FIELDS_NUMBER];
+        for (size_t j = 0; j < PSI_FIELDS_NUMBER; ++j) {
+            resourceValues[j] = 0.;
+        }
+
+        const char* pos = m_files[i]->read();
+        while (pos && *pos != '\0') {
+            // The CPU has no 'full' line before Linux 5.13
+            double* lineValues = strncmp(pos, "full", 4) == 0 ? &resourceValues[3] : &resourceValues[0];
+            for (size_t j = 0; j < 3; ++j) {
+                const char* equal = strchr(pos, '=');
+                const char* end = strchr(pos, '\n');
+                if (!equal || (end && equal > end)) {
+                    break;
+                }
+                pos = ProcFile::parseDecimal(equal + 1, lineValues[j]);
+            }
+            pos = ProcFile::nextLine(pos);
+        }
+    }
+}
+
+}
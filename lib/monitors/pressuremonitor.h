@@ -0,0 +1,46 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef PRESSUREMONITOR_H_
+#define PRESSUREMONITOR_H_
+
+#include "api.h"
+#include "imetricmonitor.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+class ProcFile;
+
+/**
+ * Monitor of the pressure stall information (PSI) of the CPU, memory and I/O resources
+ *
+ * Records one 'psi' event per resource with the share of time (in %) some or all ('full')
+ * tasks were stalled on the resource, averaged over the last 10 s, 60 s and 300 s.
+ */
+class PressureMonitor : public IMetricMonitor
+{
+public:
+    // pressureDir holds the 'cpu', 'memory' and 'io' files, by default /proc/pressure. A cgroup v2
+    // directory can also be passed to monitor the pressure of this cgroup ('<resource>.pressure' files)
+    UPROFAPI explicit PressureMonitor(const std::string& pressureDir = "");
+    UPROFAPI virtual ~PressureMonitor();
+
+    UPROFAPI MetricSchema schema() const override;
+    UPROFAPI void sample(double* values) override;
+
+private:
+    std::vector<std::string> m_resources;
+    std::vector<std::unique_ptr<ProcFile>> m_files;
+};
+
+}
+#endif /* PRESSUREMONITOR_H_ */
@@ -0,0 +1,195 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "topologymonitors.h"
+#include "util/cputopology.h"
+#include "util/systemroot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace uprofile
+{
+
+static const char* const NODE_MEMINFO_KEYS[] = {"MemTotal", "MemFree", "MemUsed", "FilePages", "AnonPages"};
+static const size_t NODE_MEMINFO_FIELDS_NUMBER = 5;
+static const size_t PROC_NUMA_FIELDS_NUMBER = 3;
+
+static bool startsWith(const char* pos, const char* prefix, size_t length)
+{
+    return strncmp(pos, prefix, length) == 0;
+}
+
+CpuFrequencyMonitor::CpuFrequencyMonitor()
+{
+    std::vector<int> cpus = CpuTopology::presentCpus();
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        std::string dir = SystemRoot::path("/sys/devices/system/cpu/cpu" + std::to_string(cpus[i]) + "/cpufreq");
+        std::unique_ptr<ProcFile> current(new ProcFile(dir + "/scaling_cur_freq"));
+        if (!current->isOpen()) {
+            // No cpufreq driver or CPU offline
+            continue;
+        }
+        m_cpus.push_back(cpus[i]);
+        m_paths.push_back(dir + "/scaling_cur_freq");
+        m_paths.push_back(dir + "/scaling_max_freq");
+        m_files.push_back(std::move(current));
+        m_files.emplace_back(new ProcFile(m_paths.back()));
+    }
+}
+
+MetricSchema CpuFrequencyMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "cpu_freq";
+    for (size_t i = 0; i < m_cpus.size(); ++i) {
+        schema.instances.push_back(std::to_string(m_cpus[i]));
+    }
+    schema.fields = {"mhz", "max_mhz"};
+    return schema;
+}
+
+double CpuFrequencyMonitor::readFrequency(size_t file)
+{
+    const char* content = m_files[file]->read();
+    if (!content) {
+        // The cpufreq files of an offline CPU are removed: open them again in case it is back
+        m_files[file].reset(new ProcFile(m_paths[file]));
+        content = m_files[file]->read();
+    }
+    unsigned long long frequency = 0;
+    if (content) {
+        ProcFile::parseNumber(content, frequency);
+    }
+    return frequency / 1000.; // kHz to MHz
+}
+
+void CpuFrequencyMonitor::sample(double* values)
+{
+    for (size_t i = 0; i < m_files.size(); ++i) {
+        values[i] = readFrequency(i);
+    }
+}
+
+NumaMemoryMonitor::NumaMemoryMonitor() :
+    m_nodes(CpuTopology::nodes())
+{
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        m_files.emplace_back(new ProcFile(SystemRoot::path("/sys/devices/system/node/node" + std::to_string(m_nodes[i]) + "/meminfo")));
+    }
+}
+
+MetricSchema NumaMemoryMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "numa_mem";
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        schema.instances.push_back(std::to_string(m_nodes[i]));
+    }
+    schema.fields = {"total", "free", "used", "file", "anon"};
+    return schema;
+}
+
+void NumaMemoryMonitor::sample(double* values)
+{
+    // Node meminfo files dump the following info:
+    // Node 0 MemTotal:       32657852 kB
+    // Node 0 MemFree:         1250596 kB
+    // Node 0 MemUsed:        31407256 kB
+    // ...
+    for (size_t i = 0; i < m_files.size(); ++i) {
+        double* nodeValues = &values[i * NODE_MEMINFO_FIELDS_NUMBER];
+        std::fill(nodeValues, nodeValues + NODE_MEMINFO_FIELDS_NUMBER, 0.);
+        const char* pos = m_files[i]->read();
+        while (pos && *pos != '\0') {
+            // Skip the 'Node <id>' prefix
+            unsigned long long value = 0;
+            pos = ProcFile::skipSpaces(pos);
+            pos = ProcFile::parseNumber(pos + ProcFile::wordLength(pos), value);
+            pos = ProcFile::skipSpaces(pos);
+            size_t length = ProcFile::wordLength(pos);
+            for (size_t j = 0; j < NODE_MEMINFO_FIELDS_NUMBER; ++j) {
+                if (strlen(NODE_MEMINFO_KEYS[j]) == length && startsWith(pos, NODE_MEMINFO_KEYS[j], length)) {
+                    ProcFile::parseNumber(pos + length + 1, value);
+                    nodeValues[j] = static_cast<double>(value);
+                    break;
+                }
+            }
+            pos = ProcFile::nextLine(pos);
+        }
+    }
+}
+
+ProcessNumaMonitor::ProcessNumaMonitor() :
+    m_file(SystemRoot::path("/proc/self/numa_maps")),
+    m_nodes(CpuTopology::nodes())
+{
+    if (!m_file.isOpen()) {
+        m_nodes.clear();
+    }
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        if (static_cast<size_t>(m_nodes[i]) >= m_instances.size()) {
+            m_instances.resize(m_nodes[i] + 1, -1);
+        }
+        m_instances[m_nodes[i]] = static_cast<int>(i);
+    }
+    m_linePages.resize(m_nodes.size(), 0);
+}
+
+MetricSchema ProcessNumaMonitor::schema() const
+{
+    MetricSchema schema;
+    schema.name = "proc_numa";
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        schema.instances.push_back(std::to_string(m_nodes[i]));
+    }
+    schema.fields = {"total", "anon", "file"};
+    return schema;
+}
+
+void ProcessNumaMonitor::sample(double* values)
+{
+    // numa_maps lists each mapping with its pages on each node:
+    // 7f3b3c000000 default anon=33 dirty=33 active=0 N0=21 N1=12 kernelpagesize_kB=4
+    // 7f3b3d200000 default file=/usr/lib/libc.so.6 mapped=40 mapmax=30 N0=40 kernelpagesize_kB=4
+    std::fill(values, values + m_nodes.size() * PROC_NUMA_FIELDS_NUMBER, 0.);
+    const char* pos = m_file.read();
+    while (pos && *pos != '\0') {
+        std::fill(m_linePages.begin(), m_linePages.end(), 0);
+        unsigned long long pageSize = 4;
+        bool file = false;
+        while (*pos != '\0' && *pos != '\n') {
+            pos = ProcFile::skipSpaces(pos);
+            const char* word = pos;
+            while (*pos != '\0' && *pos != '\n' && *pos != ' ') {
+                ++pos;
+            }
+            if (word[0] == 'N' && word[1] >= '0' && word[1] <= '9') {
+                unsigned long long node = 0, pages = 0;
+                const char* next = ProcFile::parseNumber(word + 1, node);
+                if (*next == '=' && node < m_instances.size() && m_instances[node] >= 0) {
+                    ProcFile::parseNumber(next + 1, pages);
+                    m_linePages[m_instances[node]] += pages;
+                }
+            } else if (startsWith(word, "kernelpagesize_kB=", 18)) {
+                ProcFile::parseNumber(word + 18, pageSize);
+            } else if (startsWith(word, "file=", 5)) {
+                file = true;
+            }
+        }
+        for (size_t i = 0; i < m_linePages.size(); ++i) {
+            double size = static_cast<double>(m_linePages[i] * pageSize);
+            values[i * PROC_NUMA_FIELDS_NUMBER] += size;
+            values[i * PROC_NUMA_FIELDS_NUMBER + (file ? 2 : 1)] += size;
+        }
+        pos = ProcFile::nextLine(pos);
+    }
+}
+
+}
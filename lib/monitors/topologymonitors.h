@@ -0,0 +1,72 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef TOPOLOGYMONITORS_H_
+#define TOPOLOGYMONITORS_H_
+
+#include "imetricmonitor.h"
+#include "util/procfile.h"
+
+#include <memory>
+
+namespace uprofile
+{
+
+// Current and maximum frequency (MHz) of each present CPU (cpufreq), 0 while a CPU is offline
+class CpuFrequencyMonitor : public IMetricMonitor
+{
+public:
+    CpuFrequencyMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    double readFrequency(size_t file);
+
+    std::vector<int> m_cpus;
+    // Current and maximum frequency files of each CPU, reopened when a CPU comes back online
+    std::vector<std::string> m_paths;
+    std::vector<std::unique_ptr<ProcFile>> m_files;
+};
+
+// Memory (KiB) of each NUMA node (/sys/devices/system/node/node*/meminfo)
+class NumaMemoryMonitor : public IMetricMonitor
+{
+public:
+    NumaMemoryMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    std::vector<int> m_nodes;
+    std::vector<std::unique_ptr<ProcFile>> m_files;
+};
+
+// Memory (KiB) of the process on each NUMA node, summed from /proc/self/numa_maps.
+// Reading numa_maps walks the page tables of the process: use a period of a second or more.
+class ProcessNumaMonitor : public IMetricMonitor
+{
+public:
+    ProcessNumaMonitor();
+
+    MetricSchema schema() const override;
+    void sample(double* values) override;
+
+private:
+    ProcFile m_file;
+    std::vector<int> m_nodes;
+    std::vector<int> m_instances; // instance of each node id, -1 if not monitored
+    std::vector<unsigned long long> m_linePages;
+};
+
+}
+
+#endif /* TOPOLOGYMONITORS_H_ */
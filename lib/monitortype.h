@@ -0,0 +1,34 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef MONITOR_TYPE_H_
+#define MONITOR_TYPE_H_
+
+namespace uprofile
+{
+
+enum class MonitorType {
+    PROCESS_MEMORY, // Memory used by the process
+    SYSTEM_MEMORY,  // Global memory used on the system
+    CPU,            // Usage of each CPU
+    GPU_USAGE,      // Usage of each GPU
+    GPU_MEMORY,     // Memory of each GPU
+    PROCESS_IO,     // I/O of the process
+    DISK_IO,        // I/O of each block device
+    NETWORK_IO,     // I/O of each network interface
+    CGROUP,         // CPU and memory of the cgroup of the process
+    PRESSURE,       // Pressure stall information of each resource
+    CPU_FREQUENCY,  // Frequency of each CPU
+    NUMA_MEMORY,    // Memory of each NUMA node
+    PROCESS_NUMA    // Memory of the process on each NUMA node
+};
+
+}
+
+#endif /* MONITOR_TYPE_H_ */
@@ -0,0 +1,199 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "profiledmutex.h"
+#include "activation.h"
+#include "lockregistry.h"
+
+namespace uprofile
+{
+
+const unsigned int ProfiledMutex::HOLD_SAMPLING;
+
+static unsigned long long now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Acquisitions are counted while holding the lock: a relaxed load and store
+// is enough and avoids any locked instruction
+static unsigned long long countAcquisition(std::atomic<unsigned long long>& acquisitions)
+{
+    unsigned long long count = acquisitions.load(std::memory_order_relaxed) + 1;
+    acquisitions.store(count, std::memory_order_relaxed);
+    return count;
+}
+
+ProfiledMutex::ProfiledMutex(const std::string& name) :
+    m_acquisitions(0),
+    m_stats(LockRegistry::instance().attach(name, &m_acquisitions))
+{
+}
+
+ProfiledMutex::~ProfiledMutex()
+{
+    LockRegistry::instance().detach(m_stats, &m_acquisitions);
+}
+
+void ProfiledMutex::lock()
+{
+    if (m_mutex.try_lock()) {
+        unsigned long long count = countAcquisition(m_acquisitions);
+        m_lockedAt = (count % HOLD_SAMPLING == 0 && isEnabled()) ? now() : 0;
+        return;
+    }
+
+    if (!isEnabled()) {
+        m_mutex.lock();
+        countAcquisition(m_acquisitions);
+        m_lockedAt = 0;
+        return;
+    }
+    unsigned long long begin = now();
+    m_mutex.lock();
+    m_lockedAt = now();
+    countAcquisition(m_acquisitions);
+    LockRegistry::recordWait(m_stats, m_lockedAt - begin);
+}
+
+bool ProfiledMutex::try_lock()
+{
+    if (!m_mutex.try_lock()) {
+        return false;
+    }
+    countAcquisition(m_acquisitions);
+    m_lockedAt = 0;
+    return true;
+}
+
+void ProfiledMutex::unlock()
+{
+    unsigned long long lockedAt = m_lockedAt;
+    m_mutex.unlock();
+    if (lockedAt != 0) {
+        LockRegistry::recordHold(m_stats, now() - lockedAt);
+    }
+}
+
+#if !defined(_WIN32)
+ProfiledSharedMutex::ProfiledSharedMutex(const std::string& name) :
+    m_acquisitions(0),
+    m_stats(LockRegistry::instance().attach(name, &m_acquisitions))
+{
+    pthread_rwlock_init(&m_lock, nullptr);
+}
+
+ProfiledSharedMutex::~ProfiledSharedMutex()
+{
+    pthread_rwlock_destroy(&m_lock);
+    LockRegistry::instance().detach(m_stats, &m_acquisitions);
+}
+
+void ProfiledSharedMutex::lock()
+{
+    if (pthread_rwlock_trywrlock(&m_lock) == 0) {
+        unsigned long long count = countAcquisition(m_acquisitions);
+        m_lockedAt = (count % ProfiledMutex::HOLD_SAMPLING == 0 && isEnabled()) ? now() : 0;
+        return;
+    }
+
+    if (!isEnabled()) {
+        pthread_rwlock_wrlock(&m_lock);
+        countAcquisition(m_acquisitions);
+        m_lockedAt = 0;
+        return;
+    }
+    unsigned long long begin = now();
+    pthread_rwlock_wrlock(&m_lock);
+    m_lockedAt = now();
+    countAcquisition(m_acquisitions);
+    LockRegistry::recordWait(m_stats, m_lockedAt - begin);
+}
+
+bool ProfiledSharedMutex::try_lock()
+{
+    if (pthread_rwlock_trywrlock(&m_lock) != 0) {
+        return false;
+    }
+    countAcquisition(m_acquisitions);
+    m_lockedAt = 0;
+    return true;
+}
+
+void ProfiledSharedMutex::unlock()
+{
+    unsigned long long lockedAt = m_lockedAt;
+    pthread_rwlock_unlock(&m_lock);
+    if (lockedAt != 0) {
+        LockRegistry::recordHold(m_stats, now() - lockedAt);
+    }
+}
+
+void ProfiledSharedMutex::lock_shared()
+{
+    // Readers hold the lock concurrently: their acquisitions need an atomic increment
+    if (pthread_rwlock_tryrdlock(&m_lock) == 0) {
+        m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!isEnabled()) {
+        pthread_rwlock_rdlock(&m_lock);
+        m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    unsigned long long begin = now();
+    pthread_rwlock_rdlock(&m_lock);
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    LockRegistry::recordWait(m_stats, now() - begin);
+}
+
+bool ProfiledSharedMutex::try_lock_shared()
+{
+    if (pthread_rwlock_tryrdlock(&m_lock) != 0) {
+        return false;
+    }
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ProfiledSharedMutex::unlock_shared()
+{
+    pthread_rwlock_unlock(&m_lock);
+}
+#endif
+
+ProfiledConditionVariable::ProfiledConditionVariable(const std::string& name) :
+    m_waits(0),
+    m_stats(LockRegistry::instance().attach(name, &m_waits))
+{
+}
+
+ProfiledConditionVariable::~ProfiledConditionVariable()
+{
+    LockRegistry::instance().detach(m_stats, &m_waits);
+}
+
+unsigned long long ProfiledConditionVariable::waitBegin()
+{
+    // Several threads may wait at the same time
+    m_waits.fetch_add(1, std::memory_order_relaxed);
+    return isEnabled() ? now() : 0;
+}
+
+void ProfiledConditionVariable::waitEnd(unsigned long long begin, bool timedOut)
+{
+    if (begin == 0) {
+        return;
+    }
+    // Only the timed out waits count as contentions
+    LockRegistry::recordWait(m_stats, now() - begin, timedOut);
+}
+
+}
@@ -0,0 +1,168 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef PROFILEDMUTEX_H_
+#define PROFILEDMUTEX_H_
+
+#include "api.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+namespace uprofile
+{
+
+struct LockStats;
+
+/**
+ * Drop-in replacement of std::mutex measuring lock contention
+ *
+ * Acquisition is first tried without blocking: an uncontended lock only
+ * counts the acquisition. The time waited for the lock is measured when it
+ * is contended, the hold time for contended acquisitions and one uncontended
+ * acquisition out of HOLD_SAMPLING. Statistics are aggregated per lock name
+ * and saved by startLockMonitoring().
+ */
+class ProfiledMutex
+{
+public:
+    static const unsigned int HOLD_SAMPLING = 16;
+
+    UPROFAPI explicit ProfiledMutex(const std::string& name);
+    UPROFAPI ~ProfiledMutex();
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    UPROFAPI void lock();
+    UPROFAPI bool try_lock();
+    UPROFAPI void unlock();
+
+private:
+    std::mutex m_mutex;
+    std::atomic<unsigned long long> m_acquisitions; // only written by the owner of the lock
+    unsigned long long m_lockedAt = 0;              // 0 when the hold time is not measured
+    LockStats* m_stats;
+};
+
+#if !defined(_WIN32)
+/**
+ * Reader/writer lock (on top of pthread_rwlock) measuring lock contention
+ *
+ * Exclusive and shared acquisitions are measured like the ProfiledMutex ones,
+ * except that the hold time is only measured for exclusive acquisitions.
+ */
+class ProfiledSharedMutex
+{
+public:
+    UPROFAPI explicit ProfiledSharedMutex(const std::string& name);
+    UPROFAPI ~ProfiledSharedMutex();
+    ProfiledSharedMutex(const ProfiledSharedMutex&) = delete;
+    ProfiledSharedMutex& operator=(const ProfiledSharedMutex&) = delete;
+
+    UPROFAPI void lock();
+    UPROFAPI bool try_lock();
+    UPROFAPI void unlock();
+
+    UPROFAPI void lock_shared();
+    UPROFAPI bool try_lock_shared();
+    UPROFAPI void unlock_shared();
+
+private:
+    pthread_rwlock_t m_lock;
+    std::atomic<unsigned long long> m_acquisitions;
+    unsigned long long m_lockedAt = 0; // exclusive acquisitions only
+    LockStats* m_stats;
+};
+#endif
+
+/**
+ * Condition variable measuring the time threads wait for a notification
+ *
+ * Each wait counts as an acquisition, its duration is recorded as the wait
+ * time and the timed out waits as contentions. Waiting on a ProfiledMutex
+ * also measures the reacquisition of the mutex once notified.
+ */
+class ProfiledConditionVariable
+{
+public:
+    UPROFAPI explicit ProfiledConditionVariable(const std::string& name);
+    UPROFAPI ~ProfiledConditionVariable();
+    ProfiledConditionVariable(const ProfiledConditionVariable&) = delete;
+    ProfiledConditionVariable& operator=(const ProfiledConditionVariable&) = delete;
+
+    void notify_one() { m_condition.notify_one(); }
+    void notify_all() { m_condition.notify_all(); }
+
+    template <typename Lock>
+    void wait(Lock& lock)
+    {
+        unsigned long long begin = waitBegin();
+        m_condition.wait(lock);
+        waitEnd(begin, false);
+    }
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate predicate)
+    {
+        while (!predicate()) {
+            wait(lock);
+        }
+    }
+
+    template <typename Lock, typename Clock, typename Duration>
+    std::cv_status wait_until(Lock& lock, const std::chrono::time_point<Clock, Duration>& time)
+    {
+        unsigned long long begin = waitBegin();
+        std::cv_status status = m_condition.wait_until(lock, time);
+        waitEnd(begin, status == std::cv_status::timeout);
+        return status;
+    }
+
+    template <typename Lock, typename Clock, typename Duration, typename Predicate>
+    bool wait_until(Lock& lock, const std::chrono::time_point<Clock, Duration>& time, Predicate predicate)
+    {
+        while (!predicate()) {
+            if (wait_until(lock, time) == std::cv_status::timeout) {
+                return predicate();
+            }
+        }
+        return true;
+    }
+
+    template <typename Lock, typename Rep, typename Period>
+    std::cv_status wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& duration)
+    {
+        return wait_until(lock, std::chrono::steady_clock::now() + duration);
+    }
+
+    template <typename Lock, typename Rep, typename Period, typename Predicate>
+    bool wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& duration, Predicate predicate)
+    {
+        return wait_until(lock, std::chrono::steady_clock::now() + duration, predicate);
+    }
+
+private:
+    // Return the beginning of the wait (0 if not measured)
+    UPROFAPI unsigned long long waitBegin();
+    UPROFAPI void waitEnd(unsigned long long begin, bool timedOut);
+
+    std::condition_variable_any m_condition;
+    std::atomic<unsigned long long> m_waits;
+    LockStats* m_stats;
+};
+
+}
+
+#endif /* PROFILEDMUTEX_H_ */
@@ -0,0 +1,230 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "profiler.h"
+#include "uprofileimpl.h"
+
+#ifdef PROFILE_ON
+#define PROFILER_IMPL_CALL(func, ...) \
+    m_impl->func(__VA_ARGS__);
+#define PROFILER_IMPL_CALL_RETURN(func, ...) \
+    return m_impl->func(__VA_ARGS__);
+#define PROFILER_CREATE_IMPL() new UProfileImpl
+#else
+#define PROFILER_IMPL_CALL(func, ...) (void)0;
+#define PROFILER_IMPL_CALL_RETURN(func, ...) \
+    return {}
+#define PROFILER_CREATE_IMPL() NULL
+#endif
+
+namespace uprofile
+{
+
+Profiler::Profiler() :
+    m_impl(PROFILER_CREATE_IMPL())
+{
+}
+
+Profiler::~Profiler()
+{
+    PROFILER_IMPL_CALL(stop);
+    delete m_impl;
+}
+
+void Profiler::start(const char* filepath, unsigned long long maxCapSize)
+{
+    PROFILER_IMPL_CALL(start, filepath, maxCapSize);
+}
+
+void Profiler::stop()
+{
+    PROFILER_IMPL_CALL(stop);
+}
+
+void Profiler::addGPUMonitor(IGPUMonitor* monitor)
+{
+    PROFILER_IMPL_CALL(addGPUMonitor, monitor);
+}
+
+void Profiler::removeGPUMonitor()
+{
+    PROFILER_IMPL_CALL(removeGPUMonitor);
+}
+
+void Profiler::addMonitor(IMetricMonitor* monitor, int period)
+{
+    PROFILER_IMPL_CALL(addMonitor, monitor, period);
+}
+
+void Profiler::removeMonitor(IMetricMonitor* monitor)
+{
+    PROFILER_IMPL_CALL(removeMonitor, monitor);
+}
+
+void Profiler::addSink(IEventSink* sink, const std::vector<std::string>& events)
+{
+    PROFILER_IMPL_CALL(addSink, sink, events);
+}
+
+void Profiler::removeSink(IEventSink* sink)
+{
+    PROFILER_IMPL_CALL(removeSink, sink);
+}
+
+void Profiler::setTimestampUnit(TimestampUnit tsUnit)
+{
+    PROFILER_IMPL_CALL(setTimestampUnit, tsUnit);
+}
+
+void Profiler::enableRollups(bool keepRawSamples, int rawRetention)
+{
+    PROFILER_IMPL_CALL(enableRollups, keepRawSamples, rawRetention);
+}
+
+void Profiler::setDeadband(MonitorType monitor, double absThreshold, double relThreshold, int heartbeat)
+{
+    PROFILER_IMPL_CALL(setDeadband, monitor, absThreshold, relThreshold, heartbeat);
+}
+
+void Profiler::enableFlightRecorder(const char* dumpPath, size_t capacity)
+{
+    PROFILER_IMPL_CALL(enableFlightRecorder, dumpPath, capacity);
+}
+
+bool Profiler::dumpFlightRecorder()
+{
+    PROFILER_IMPL_CALL_RETURN(dumpFlightRecorder);
+}
+
+void Profiler::setFlightRecorderLatencyTrigger(unsigned long long threshold)
+{
+    PROFILER_IMPL_CALL(setFlightRecorderLatencyTrigger, threshold);
+}
+
+void Profiler::addAdaptiveRule(const AdaptiveRule& rule)
+{
+    PROFILER_IMPL_CALL(addAdaptiveRule, rule);
+}
+
+void Profiler::clearAdaptiveRules()
+{
+    PROFILER_IMPL_CALL(clearAdaptiveRules);
+}
+
+void Profiler::recordTimeBegin(const std::string& title)
+{
+    PROFILER_IMPL_CALL(timeBegin, title);
+}
+
+void Profiler::recordTimeEnd(const std::string& title)
+{
+    PROFILER_IMPL_CALL(timeEnd, title);
+}
+
+void Profiler::startProcessMemoryMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startProcessMemoryMonitoring, period);
+}
+
+void Profiler::startSystemMemoryMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startSystemMemoryMonitoring, period);
+}
+
+void Profiler::startCPUUsageMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startCPUUsageMonitoring, period);
+}
+
+void Profiler::startGPUUsageMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startGPUUsageMonitoring, period);
+}
+
+void Profiler::startGPUMemoryMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startGPUMemoryMonitoring, period);
+}
+
+void Profiler::startCountersMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startCountersMonitoring, period);
+}
+
+void Profiler::startLockMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startLockMonitoring, period);
+}
+
+void Profiler::startFrameMonitoring(int period, bool rawFrameTimes)
+{
+    PROFILER_IMPL_CALL(startFrameMonitoring, period, rawFrameTimes);
+}
+
+void Profiler::startSelfMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startSelfMonitoring, period);
+}
+
+void Profiler::startProcessIOMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startProcessIOMonitoring, period);
+}
+
+void Profiler::startDiskIOMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startDiskIOMonitoring, period);
+}
+
+void Profiler::startNetworkIOMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startNetworkIOMonitoring, period);
+}
+
+void Profiler::startAffinityCPUUsageMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startAffinityCPUUsageMonitoring, period);
+}
+
+void Profiler::startCgroupMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startCgroupMonitoring, period);
+}
+
+void Profiler::startPressureMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startPressureMonitoring, period);
+}
+
+void Profiler::startCPUFrequencyMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startCPUFrequencyMonitoring, period);
+}
+
+void Profiler::startNumaMonitoring(int period)
+{
+    PROFILER_IMPL_CALL(startNumaMonitoring, period);
+}
+
+void Profiler::startThreadCPUMonitoring(int period, int topN)
+{
+    PROFILER_IMPL_CALL(startThreadCPUMonitoring, period, topN);
+}
+
+void Profiler::startProcessesMonitoring(int period, const std::vector<int>& pids)
+{
+    PROFILER_IMPL_CALL(startProcessesMonitoring, period, pids, false);
+}
+
+void Profiler::startProcessTreeMonitoring(int period, int rootPid)
+{
+    PROFILER_IMPL_CALL(startProcessesMonitoring, period, {rootPid}, true);
+}
+
+}
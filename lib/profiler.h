@@ -0,0 +1,108 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <string>
+#include <vector>
+
+#include "activation.h"
+#include "adaptiverule.h"
+#include "api.h"
+#include "ieventsink.h"
+#include "igpumonitor.h"
+#include "imetricmonitor.h"
+#include "monitortype.h"
+#include "timestampunit.h"
+
+namespace uprofile
+{
+class UProfileImpl;
+
+/**
+ * Independent profiler instance
+ *
+ * Each instance has its own output, timestamp unit, monitors and buffers so
+ * that several subsystems of a process can record without sharing a lock and
+ * save their events to different files.
+ *
+ * Methods behave like the uprofile free functions of the same name (which
+ * operate on a default instance). Unlike uprofile::stop(), stop() keeps the
+ * instance alive so that it can be started again.
+ */
+class Profiler
+{
+public:
+    UPROFAPI Profiler();
+    UPROFAPI ~Profiler();
+
+    UPROFAPI void start(const char* filepath, unsigned long long maxCapSize = 0);
+    UPROFAPI void stop();
+    UPROFAPI void addGPUMonitor(IGPUMonitor* monitor);
+    UPROFAPI void removeGPUMonitor();
+    UPROFAPI void addMonitor(IMetricMonitor* monitor, int period);
+    UPROFAPI void removeMonitor(IMetricMonitor* monitor);
+    UPROFAPI void addSink(IEventSink* sink, const std::vector<std::string>& events = std::vector<std::string>());
+    UPROFAPI void removeSink(IEventSink* sink);
+    UPROFAPI void setTimestampUnit(TimestampUnit tsUnit);
+    UPROFAPI void enableRollups(bool keepRawSamples = true, int rawRetention = 0);
+    UPROFAPI void setDeadband(MonitorType monitor, double absThreshold, double relThreshold = 0., int heartbeat = 0);
+    UPROFAPI void enableFlightRecorder(const char* dumpPath, size_t capacity = 4 * 1024 * 1024);
+    UPROFAPI bool dumpFlightRecorder();
+    UPROFAPI void setFlightRecorderLatencyTrigger(unsigned long long threshold);
+    UPROFAPI void addAdaptiveRule(const AdaptiveRule& rule);
+    UPROFAPI void clearAdaptiveRules();
+    // Inline so that a disabled category only costs an atomic load, like uprofile::timeBegin()
+    void timeBegin(const std::string& title, unsigned long long category = DEFAULT_CATEGORY)
+    {
+        if (isEnabled(category)) {
+            recordTimeBegin(title);
+        }
+    }
+    void timeEnd(const std::string& title, unsigned long long category = DEFAULT_CATEGORY)
+    {
+        if (isEnabled(category)) {
+            recordTimeEnd(title);
+        }
+    }
+    UPROFAPI void startProcessMemoryMonitoring(int period);
+    UPROFAPI void startSystemMemoryMonitoring(int period);
+    UPROFAPI void startCPUUsageMonitoring(int period);
+    UPROFAPI void startGPUUsageMonitoring(int period);
+    UPROFAPI void startGPUMemoryMonitoring(int period);
+    UPROFAPI void startCountersMonitoring(int period);
+    UPROFAPI void startLockMonitoring(int period);
+    UPROFAPI void startFrameMonitoring(int period, bool rawFrameTimes = false);
+    UPROFAPI void startSelfMonitoring(int period);
+    UPROFAPI void startProcessIOMonitoring(int period);
+    UPROFAPI void startDiskIOMonitoring(int period);
+    UPROFAPI void startNetworkIOMonitoring(int period);
+    UPROFAPI void startAffinityCPUUsageMonitoring(int period);
+    UPROFAPI void startCgroupMonitoring(int period);
+    UPROFAPI void startPressureMonitoring(int period);
+    UPROFAPI void startCPUFrequencyMonitoring(int period);
+    UPROFAPI void startNumaMonitoring(int period);
+    UPROFAPI void startThreadCPUMonitoring(int period, int topN = 0);
+    UPROFAPI void startProcessesMonitoring(int period, const std::vector<int>& pids);
+    UPROFAPI void startProcessTreeMonitoring(int period, int rootPid = 0);
+
+private:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    UPROFAPI void recordTimeBegin(const std::string& title);
+    UPROFAPI void recordTimeEnd(const std::string& title);
+
+    UProfileImpl* m_impl;
+};
+
+}
+
+#endif /* PROFILER_H_ */
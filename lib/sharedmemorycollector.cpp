@@ -0,0 +1,200 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "sharedmemorycollector.h"
+#include "eventsfile.h"
+#include "util/shmsegment.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <signal.h>
+#endif
+
+using namespace std::chrono;
+
+namespace uprofile
+{
+
+static const int DRAIN_PERIOD = 100;          // ms
+static const int LIVENESS_CHECK_PERIOD = 1000; // ms
+
+static unsigned long long steadyTimestamp()
+{
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+SharedMemoryCollector::SharedMemoryCollector(const char* name, const char* filepath, unsigned long long maxCapSize, int reorderWindow) :
+    m_name(name),
+    m_filepath(filepath),
+    m_maxCapSize(maxCapSize),
+    m_reorderWindow(reorderWindow)
+{
+}
+
+SharedMemoryCollector::~SharedMemoryCollector()
+{
+    stop();
+}
+
+bool SharedMemoryCollector::start()
+{
+    if (!m_stopped) {
+        return true;
+    }
+    m_segment.reset(ShmSegment::open(m_name));
+    if (!m_segment) {
+        return false;
+    }
+    m_file.reset(new EventsFile(m_filepath.c_str(), m_maxCapSize));
+    m_reportedDrops.assign(m_segment->slotsNumber(), 0);
+
+    // Marker record telling that the records hold the PID of their producer
+    unsigned long long now = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    std::string marker = "collector;" + std::to_string(now) + ";" + m_name + "\n";
+    m_file->write(marker.c_str(), marker.size());
+
+    m_stopped = false;
+    m_thread = std::thread(&SharedMemoryCollector::run, this);
+    return true;
+}
+
+void SharedMemoryCollector::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopped) {
+            return;
+        }
+        m_stopped = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+    drain(true);
+    m_file.reset();
+    m_segment.reset();
+}
+
+void SharedMemoryCollector::removeSegment(const char* name)
+{
+    ShmSegment::remove(name);
+}
+
+void SharedMemoryCollector::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopped) {
+        lock.unlock();
+        drain(false);
+        lock.lock();
+        m_cond.wait_for(lock, milliseconds(DRAIN_PERIOD), [this]() { return m_stopped; });
+    }
+}
+
+void SharedMemoryCollector::drain(bool final)
+{
+#if defined(__linux__)
+    unsigned long long now = steadyTimestamp();
+    bool checkLiveness = final || now - m_lastLivenessCheck >= LIVENESS_CHECK_PERIOD;
+    if (checkLiveness) {
+        m_lastLivenessCheck = now;
+    }
+
+    std::string records;
+    for (unsigned int i = 0; i < m_segment->slotsNumber(); ++i) {
+        ShmSegment::Slot& slot = m_segment->slot(i);
+        int pid = slot.pid.load(std::memory_order_acquire);
+        if (pid == 0) {
+            continue;
+        }
+
+        // Check the producer state before draining so that all its records are read before releasing the slot
+        bool released = slot.closed.load(std::memory_order_acquire) != 0;
+        if (!released && checkLiveness) {
+            unsigned long long startTime = slot.startTime.load(std::memory_order_acquire);
+            released = (kill(pid, 0) == -1 && errno == ESRCH) ||
+                       (startTime != 0 && ShmSegment::processStartTime(pid) != startTime); // PID reused by another process
+        }
+
+        records.clear();
+        m_segment->pop(i, records);
+        collect(pid, records, now);
+
+        unsigned long long dropped = slot.dropped.load(std::memory_order_relaxed);
+        if (dropped > m_reportedDrops[i]) {
+            collect(pid, "dropped;" + std::to_string(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count()) + ";" +
+                             std::to_string(dropped - m_reportedDrops[i]) + "\n",
+                    now);
+            m_reportedDrops[i] = dropped;
+        }
+
+        if (released) {
+            m_segment->freeSlot(i);
+            m_reportedDrops[i] = 0;
+        }
+    }
+
+    // Write the records older than the reordering window
+    std::stable_sort(m_pending.begin(), m_pending.end(), [](const Record& a, const Record& b) { return a.timestamp < b.timestamp; });
+    size_t count = 0;
+    if (final) {
+        count = m_pending.size();
+    } else {
+        // Records are written in timestamp order, up to the first one still within the window
+        while (count < m_pending.size() && m_pending[count].arrival + m_reorderWindow <= now) {
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+    std::string output;
+    for (size_t i = 0; i < count; ++i) {
+        output += m_pending[i].line;
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+    m_file->write(output.c_str(), output.size());
+#endif
+}
+
+void SharedMemoryCollector::collect(int pid, const std::string& records, unsigned long long arrival)
+{
+    const std::string tag = std::to_string(pid);
+    size_t begin = 0;
+    while (begin < records.size()) {
+        size_t end = records.find('\n', begin);
+        if (end == std::string::npos) {
+            break;
+        }
+        // Insert the PID after the timestamp: 'type;timestamp;pid;...'
+        size_t typeEnd = records.find(';', begin);
+        if (typeEnd != std::string::npos && typeEnd < end) {
+            size_t timestampEnd = records.find(';', typeEnd + 1);
+            if (timestampEnd == std::string::npos || timestampEnd > end) {
+                timestampEnd = end;
+            }
+            Record record;
+            record.timestamp = strtoull(records.c_str() + typeEnd + 1, nullptr, 10);
+            record.arrival = arrival;
+            record.line.reserve(end - begin + tag.size() + 2);
+            record.line.append(records, begin, timestampEnd - begin);
+            record.line += ';';
+            record.line += tag;
+            record.line.append(records, timestampEnd, end - timestampEnd);
+            record.line += '\n';
+            m_pending.push_back(std::move(record));
+        }
+        begin = end + 1;
+    }
+}
+
+}
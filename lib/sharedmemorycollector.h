@@ -0,0 +1,80 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SHAREDMEMORYCOLLECTOR_H_
+#define SHAREDMEMORYCOLLECTOR_H_
+
+#include "api.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uprofile
+{
+
+class EventsFile;
+class ShmSegment;
+
+/**
+ * Collector gathering into a single file the events published by the
+ * SharedMemorySink of several processes
+ *
+ * The rings of the shared memory segment are drained periodically. The PID of
+ * the producer is inserted after the timestamp of each record
+ * ('type;timestamp;pid;...') and records are reordered by timestamp within
+ * a time window. The slot of a process is released once it has stopped or
+ * exited (its ring being drained).
+ */
+class SharedMemoryCollector
+{
+public:
+    UPROFAPI SharedMemoryCollector(const char* name, const char* filepath, unsigned long long maxCapSize = 0, int reorderWindow = 500 /* ms */);
+    UPROFAPI ~SharedMemoryCollector();
+
+    // Create (or attach to) the shared memory segment and start draining it
+    UPROFAPI bool start();
+    // Drain the remaining events and stop
+    UPROFAPI void stop();
+
+    // Remove the shared memory segment name (mapped segments remain valid)
+    UPROFAPI static void removeSegment(const char* name);
+
+private:
+    struct Record {
+        unsigned long long timestamp;
+        unsigned long long arrival; // ms (steady clock)
+        std::string line;
+    };
+
+    void run();
+    void drain(bool final);
+    void collect(int pid, const std::string& records, unsigned long long arrival);
+
+    std::string m_name;
+    std::string m_filepath;
+    unsigned long long m_maxCapSize;
+    int m_reorderWindow;
+    std::unique_ptr<ShmSegment> m_segment;
+    std::unique_ptr<EventsFile> m_file;
+    std::vector<Record> m_pending;
+    std::vector<unsigned long long> m_reportedDrops;
+    unsigned long long m_lastLivenessCheck = 0;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stopped = true;
+};
+
+}
+
+#endif /* SHAREDMEMORYCOLLECTOR_H_ */
@@ -0,0 +1,22 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "callbacksink.h"
+
+uprofile::CallbackSink::CallbackSink(const Callback& callback) :
+    m_callback(callback)
+{
+}
+
+void uprofile::CallbackSink::write(const char* records, size_t size, size_t count)
+{
+    if (m_callback) {
+        m_callback(records, size, count);
+    }
+}
@@ -0,0 +1,37 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef CALLBACKSINK_H_
+#define CALLBACKSINK_H_
+
+#include "api.h"
+#include "ieventsink.h"
+#include <functional>
+
+namespace uprofile
+{
+
+/**
+ * Sink forwarding each batch of events to a user function
+ */
+class CallbackSink : public IEventSink
+{
+public:
+    using Callback = std::function<void(const char* records, size_t size, size_t count)>;
+
+    UPROFAPI explicit CallbackSink(const Callback& callback);
+
+    UPROFAPI void write(const char* records, size_t size, size_t count) override;
+
+private:
+    Callback m_callback;
+};
+
+}
+#endif /* CALLBACKSINK_H_ */
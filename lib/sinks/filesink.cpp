@@ -0,0 +1,25 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "filesink.h"
+#include "eventsfile.h"
+
+uprofile::FileSink::FileSink(const char* filepath, unsigned long long maxCapSize) :
+    m_file(new EventsFile(filepath, maxCapSize))
+{
+}
+
+uprofile::FileSink::~FileSink()
+{
+}
+
+void uprofile::FileSink::write(const char* records, size_t size, size_t /*count*/)
+{
+    m_file->write(records, size);
+}
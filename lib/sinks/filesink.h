@@ -0,0 +1,37 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef FILESINK_H_
+#define FILESINK_H_
+
+#include "api.h"
+#include "ieventsink.h"
+#include <memory>
+
+namespace uprofile
+{
+class EventsFile;
+
+/**
+ * Sink saving events to a file (optionally to two rotating files, see uprofile::start())
+ */
+class FileSink : public IEventSink
+{
+public:
+    UPROFAPI explicit FileSink(const char* filepath, unsigned long long maxCapSize = 0);
+    UPROFAPI virtual ~FileSink();
+
+    UPROFAPI void write(const char* records, size_t size, size_t count) override;
+
+private:
+    std::unique_ptr<EventsFile> m_file;
+};
+
+}
+#endif /* FILESINK_H_ */
@@ -0,0 +1,82 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "memorysink.h"
+
+#include <algorithm>
+#include <string.h>
+
+uprofile::MemorySink::MemorySink(size_t capacity) :
+    m_buffer(capacity)
+{
+}
+
+void uprofile::MemorySink::write(const char* records, size_t size, size_t /*count*/)
+{
+    const size_t capacity = m_buffer.size();
+    if (capacity == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (size > capacity) {
+        // Only the most recent whole records of the batch can fit
+        const char* end = records + size;
+        const char* first = records + size - capacity;
+        if (*(first - 1) != '\n') {
+            first = static_cast<const char*>(memchr(first, '\n', end - first));
+            first = first ? first + 1 : end;
+        }
+        m_begin = 0;
+        m_size = 0;
+        records = first;
+        size = end - first;
+    }
+
+    if (m_size + size > capacity) {
+        drop(m_size + size - capacity);
+    }
+
+    size_t pos = (m_begin + m_size) % capacity;
+    size_t firstPart = std::min(size, capacity - pos);
+    memcpy(&m_buffer[pos], records, firstPart);
+    memcpy(&m_buffer[0], records + firstPart, size - firstPart);
+    m_size += size;
+}
+
+void uprofile::MemorySink::drop(size_t size)
+{
+    const size_t capacity = m_buffer.size();
+    m_begin = (m_begin + size) % capacity;
+    m_size -= size;
+
+    // Drop the remaining of the truncated record
+    while (m_size > 0 && m_buffer[(m_begin + capacity - 1) % capacity] != '\n') {
+        m_begin = (m_begin + 1) % capacity;
+        m_size--;
+    }
+}
+
+std::string uprofile::MemorySink::content() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string result;
+    result.reserve(m_size);
+    size_t firstPart = std::min(m_size, m_buffer.size() - m_begin);
+    result.append(&m_buffer[0] + m_begin, firstPart);
+    result.append(&m_buffer[0], m_size - firstPart);
+    return result;
+}
+
+void uprofile::MemorySink::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_begin = 0;
+    m_size = 0;
+}
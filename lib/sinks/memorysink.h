@@ -0,0 +1,49 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef MEMORYSINK_H_
+#define MEMORYSINK_H_
+
+#include "api.h"
+#include "ieventsink.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Sink keeping the most recent events in a fixed size memory ring
+ *
+ * When the ring is full, the oldest records are dropped. Only whole
+ * records are kept.
+ */
+class MemorySink : public IEventSink
+{
+public:
+    UPROFAPI explicit MemorySink(size_t capacity /* bytes */);
+
+    UPROFAPI void write(const char* records, size_t size, size_t count) override;
+
+    // Return the records currently held (oldest first)
+    UPROFAPI std::string content() const;
+    UPROFAPI void clear();
+
+private:
+    void drop(size_t size);
+
+    mutable std::mutex m_mutex;
+    std::vector<char> m_buffer;
+    size_t m_begin = 0; // position of the oldest byte
+    size_t m_size = 0;
+};
+
+}
+#endif /* MEMORYSINK_H_ */
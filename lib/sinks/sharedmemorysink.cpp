@@ -0,0 +1,66 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "sharedmemorysink.h"
+#include "util/shmsegment.h"
+
+#include <iostream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+uprofile::SharedMemorySink::SharedMemorySink(const char* name) :
+    m_name(name)
+{
+}
+
+uprofile::SharedMemorySink::~SharedMemorySink()
+{
+#if defined(__linux__)
+    if (m_segment && m_slot != -1 && m_pid == getpid()) {
+        m_segment->closeSlot(m_slot);
+    }
+#endif
+}
+
+bool uprofile::SharedMemorySink::claimSlot()
+{
+#if defined(__linux__)
+    // Claim is only attempted once per process
+    m_pid = getpid();
+    m_slot = -1;
+    if (!m_segment) {
+        m_segment.reset(ShmSegment::open(m_name));
+        if (!m_segment) {
+            return false;
+        }
+    }
+    m_slot = m_segment->claimSlot(m_pid, ShmSegment::processStartTime(m_pid));
+    if (m_slot == -1) {
+        std::cerr << "No free slot in shared memory segment " << m_name << std::endl;
+    }
+    return m_slot != -1;
+#else
+    return false;
+#endif
+}
+
+void uprofile::SharedMemorySink::write(const char* records, size_t size, size_t /*count*/)
+{
+#if defined(__linux__)
+    if (m_pid != getpid()) {
+        claimSlot();
+    }
+    if (m_slot == -1) {
+        return;
+    }
+    m_segment->push(m_slot, records, size);
+#endif
+}
@@ -0,0 +1,50 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SHAREDMEMORYSINK_H_
+#define SHAREDMEMORYSINK_H_
+
+#include "api.h"
+#include "ieventsink.h"
+#include <memory>
+#include <string>
+
+namespace uprofile
+{
+
+class ShmSegment;
+
+/**
+ * Sink publishing events into a named shared memory segment drained by a
+ * SharedMemoryCollector
+ *
+ * Each process writes into its own ring of the segment (claimed on the first
+ * write), so that the events of several processes are gathered into a single
+ * file without any lock between them. When the ring is full (no collector or
+ * collector too slow), records are dropped and counted.
+ */
+class SharedMemorySink : public IEventSink
+{
+public:
+    UPROFAPI explicit SharedMemorySink(const char* name /* e.g. "/uprofile" */);
+    UPROFAPI virtual ~SharedMemorySink();
+
+    UPROFAPI void write(const char* records, size_t size, size_t count) override;
+
+private:
+    bool claimSlot();
+
+    std::string m_name;
+    std::unique_ptr<ShmSegment> m_segment;
+    int m_slot = -1;
+    int m_pid = 0; // process owning the slot (a forked child claims its own slot)
+};
+
+}
+#endif /* SHAREDMEMORYSINK_H_ */
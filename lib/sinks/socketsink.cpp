@@ -0,0 +1,118 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "socketsink.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+const int uprofile::SocketSink::SEND_TIMEOUT;
+
+uprofile::SocketSink::SocketSink(const char* socketPath) :
+    m_socketPath(socketPath),
+    m_droppedRecords(0)
+{
+}
+
+uprofile::SocketSink::~SocketSink()
+{
+    closeSocket();
+}
+
+bool uprofile::SocketSink::connectSocket()
+{
+#if defined(__linux__)
+    struct sockaddr_un addr;
+    if (m_socketPath.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_fd == -1) {
+        return false;
+    }
+    // A Unix socket connects at once, or fails with EAGAIN when the backlog of the peer is full
+    if (connect(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        closeSocket();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void uprofile::SocketSink::closeSocket()
+{
+#if defined(__linux__)
+    if (m_fd != -1) {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+}
+
+void uprofile::SocketSink::write(const char* records, size_t size, size_t count)
+{
+#if defined(__linux__)
+    if (m_fd == -1 && !connectSocket()) {
+        m_droppedRecords += count;
+        return;
+    }
+
+    const char* begin = records;
+    const char* end = records + size;
+    while (records < end) {
+        // MSG_NOSIGNAL: a closed peer should not raise SIGPIPE in the profiled process
+        ssize_t sent = send(m_fd, records, end - records, MSG_NOSIGNAL);
+        if (sent == -1 && errno == EINTR) {
+            continue;
+        }
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (records == begin) {
+                // Socket buffer full: drop the whole batch, the stream stays made of whole records
+                m_droppedRecords += count;
+                return;
+            }
+            // Complete the records already started
+            struct pollfd pfd = {m_fd, POLLOUT, 0};
+            if (poll(&pfd, 1, SEND_TIMEOUT) > 0 && !(pfd.revents & (POLLERR | POLLHUP))) {
+                continue;
+            }
+        }
+        if (sent == -1) {
+            m_droppedRecords += std::count(records, end, '\n');
+            closeSocket();
+            return;
+        }
+        records += sent;
+    }
+#else
+    (void)records;
+    (void)size;
+    m_droppedRecords += count;
+#endif
+}
+
+unsigned long long uprofile::SocketSink::droppedRecords() const
+{
+    return m_droppedRecords;
+}
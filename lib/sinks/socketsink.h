@@ -0,0 +1,52 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SOCKETSINK_H_
+#define SOCKETSINK_H_
+
+#include "api.h"
+#include "ieventsink.h"
+#include <atomic>
+#include <string>
+
+namespace uprofile
+{
+
+/**
+ * Sink streaming events to a Unix domain socket (SOCK_STREAM)
+ *
+ * The connection is established lazily and re-established after any failure.
+ * The socket is non-blocking so that a slow peer never stalls the writer thread:
+ * a batch is dropped when the peer is not reachable or its socket buffer is full,
+ * and a batch partially sent is completed within SEND_TIMEOUT or the connection is
+ * closed (the peer then gets an incomplete last record). Dropped records are counted.
+ */
+class SocketSink : public IEventSink
+{
+public:
+    UPROFAPI explicit SocketSink(const char* socketPath);
+    UPROFAPI virtual ~SocketSink();
+
+    UPROFAPI void write(const char* records, size_t size, size_t count) override;
+    // Number of records which have not been (entirely) sent
+    UPROFAPI unsigned long long droppedRecords() const;
+
+    static const int SEND_TIMEOUT = 50; // ms
+
+private:
+    bool connectSocket();
+    void closeSocket();
+
+    std::string m_socketPath;
+    int m_fd = -1;
+    std::atomic<unsigned long long> m_droppedRecords;
+};
+
+}
+#endif /* SOCKETSINK_H_ */
@@ -12,6 +12,12 @@
 #include <iostream>
 #include <sstream>
 
+#include "activationimpl.h"
+#include "counters.h"
+#include "frametracker.h"
+#include "util/flightrecorder.h"
+#include "util/stacksampler.h"
+#include "util/systemroot.h"
 #include "uprofile.h"
 #include "uprofileimpl.h"
 
@@ -24,11 +30,29 @@ using namespace std::chrono;
     return UProfileImpl::getInstance()->func(__VA_ARGS__);
 #define UPROFILE_DESTROY_INSTANCE() \
     UProfileImpl::destroyInstance();
+#define UPROFILE_ACTIVATION_CALL(func, ...) \
+    Activation::func(__VA_ARGS__);
+#define UPROFILE_COUNTERS_CALL(func, ...) \
+    CounterRegistry::instance().func(__VA_ARGS__);
+#define UPROFILE_RECORDER_CALL(func, ...) \
+    FlightRecorder::func(__VA_ARGS__);
+#define UPROFILE_SAMPLER_CALL(func, ...) \
+    StackSampler::instance().func(__VA_ARGS__);
+#define UPROFILE_FRAMES_CALL(func, ...) \
+    FrameTracker::instance().func(__VA_ARGS__);
+#define UPROFILE_SYSTEMROOT_CALL(func, ...) \
+    SystemRoot::func(__VA_ARGS__);
 #else
 #define UPROFILE_INSTANCE_CALL(func, ...) (void)0;
 #define UPROFILE_INSTANCE_CALL_RETURN(func, ...) \
     return {}
 #define UPROFILE_DESTROY_INSTANCE() (void)0;
+#define UPROFILE_ACTIVATION_CALL(func, ...) (void)0;
+#define UPROFILE_COUNTERS_CALL(func, ...) (void)0;
+#define UPROFILE_RECORDER_CALL(func, ...) (void)0;
+#define UPROFILE_SAMPLER_CALL(func, ...) (void)0;
+#define UPROFILE_FRAMES_CALL(func, ...) (void)0;
+#define UPROFILE_SYSTEMROOT_CALL(func, ...) (void)0;
 #endif
 
 namespace uprofile
@@ -55,11 +79,138 @@ void removeGPUMonitor()
     UPROFILE_INSTANCE_CALL(removeGPUMonitor);
 }
 
+void addMonitor(IMetricMonitor* monitor, int period)
+{
+    UPROFILE_INSTANCE_CALL(addMonitor, monitor, period);
+}
+
+void removeMonitor(IMetricMonitor* monitor)
+{
+    UPROFILE_INSTANCE_CALL(removeMonitor, monitor);
+}
+
+void addSink(IEventSink* sink, const std::vector<std::string>& events)
+{
+    UPROFILE_INSTANCE_CALL(addSink, sink, events);
+}
+
+void removeSink(IEventSink* sink)
+{
+    UPROFILE_INSTANCE_CALL(removeSink, sink);
+}
+
 void setTimestampUnit(TimestampUnit tsUnit)
 {
     UPROFILE_INSTANCE_CALL(setTimestampUnit, tsUnit);
 }
 
+void setSystemRoot(const std::string& root)
+{
+    UPROFILE_SYSTEMROOT_CALL(set, root);
+}
+
+void enableRollups(bool keepRawSamples, int rawRetention)
+{
+    UPROFILE_INSTANCE_CALL(enableRollups, keepRawSamples, rawRetention);
+}
+
+void setDeadband(MonitorType monitor, double absThreshold, double relThreshold, int heartbeat)
+{
+    UPROFILE_INSTANCE_CALL(setDeadband, monitor, absThreshold, relThreshold, heartbeat);
+}
+
+void enableFlightRecorder(const char* dumpPath, size_t capacity)
+{
+    UPROFILE_INSTANCE_CALL(enableFlightRecorder, dumpPath, capacity);
+}
+
+bool dumpFlightRecorder()
+{
+    UPROFILE_INSTANCE_CALL_RETURN(dumpFlightRecorder);
+}
+
+void setFlightRecorderLatencyTrigger(unsigned long long threshold)
+{
+    UPROFILE_INSTANCE_CALL(setFlightRecorderLatencyTrigger, threshold);
+}
+
+void addAdaptiveRule(const AdaptiveRule& rule)
+{
+    UPROFILE_INSTANCE_CALL(addAdaptiveRule, rule);
+}
+
+void clearAdaptiveRules()
+{
+    UPROFILE_INSTANCE_CALL(clearAdaptiveRules);
+}
+
+void startStackSampling(const char* foldedPath, int frequency, int maxDepth)
+{
+    UPROFILE_SAMPLER_CALL(start, foldedPath ? foldedPath : "", frequency, maxDepth);
+}
+
+void stopStackSampling()
+{
+    UPROFILE_SAMPLER_CALL(stop);
+}
+
+void startFunctionInstrumentation(unsigned int minDuration)
+{
+    UPROFILE_INSTANCE_CALL(startFunctionInstrumentation, minDuration);
+}
+
+void stopFunctionInstrumentation()
+{
+    UPROFILE_INSTANCE_CALL(stopFunctionInstrumentation);
+}
+
+void setFunctionFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes)
+{
+    UPROFILE_INSTANCE_CALL(setFunctionFilters, includes, excludes);
+}
+
+void enableFlightRecorderSignal(int signum)
+{
+    UPROFILE_RECORDER_CALL(enableSignalDump, signum);
+}
+
+void enableFlightRecorderCrashDump()
+{
+    UPROFILE_RECORDER_CALL(enableCrashDump);
+}
+
+void setEnabled(bool enabled)
+{
+    UPROFILE_ACTIVATION_CALL(setEnabled, enabled);
+}
+
+void setCategories(unsigned long long categories)
+{
+    UPROFILE_ACTIVATION_CALL(setCategories, categories);
+}
+
+void enableSignalToggle(int signum)
+{
+    UPROFILE_ACTIVATION_CALL(enableSignalToggle, signum);
+}
+
+// timeBegin() and timeEnd() were exported without category by the previous versions: the symbols
+// are kept for the binaries built against them
+UPROFAPI void timeBegin(const std::string& title);
+UPROFAPI void timeEnd(const std::string& title);
+
+void timeBegin(const std::string& title)
+{
+    timeBegin(title, DEFAULT_CATEGORY);
+}
+
+void timeEnd(const std::string& title)
+{
+    timeEnd(title, DEFAULT_CATEGORY);
+}
+
+namespace detail
+{
 void timeBegin(const std::string& step)
 {
     UPROFILE_INSTANCE_CALL(timeBegin, step);
@@ -70,6 +221,27 @@ void timeEnd(const std::string& step)
     UPROFILE_INSTANCE_CALL(timeEnd, step);
 }
 
+void counterAdd(const std::string& name, long long delta)
+{
+    UPROFILE_COUNTERS_CALL(counterAdd, name, delta);
+}
+
+void gaugeSet(const std::string& name, double value)
+{
+    UPROFILE_COUNTERS_CALL(gaugeSet, name, value);
+}
+
+void histogramRecord(const std::string& name, double value)
+{
+    UPROFILE_COUNTERS_CALL(histogramRecord, name, value);
+}
+
+void markFrame(const std::string& channel)
+{
+    UPROFILE_FRAMES_CALL(mark, channel);
+}
+}
+
 void startProcessMemoryMonitoring(int period)
 {
     UPROFILE_INSTANCE_CALL(startProcessMemoryMonitoring, period);
@@ -95,6 +267,86 @@ void startGPUMemoryMonitoring(int period)
     UPROFILE_INSTANCE_CALL(startGPUMemoryMonitoring, period);
 }
 
+void startCountersMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startCountersMonitoring, period);
+}
+
+void startLockMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startLockMonitoring, period);
+}
+
+void setFrameRate(const std::string& channel, double fps)
+{
+    UPROFILE_FRAMES_CALL(setFrameRate, channel, fps);
+}
+
+void startFrameMonitoring(int period, bool rawFrameTimes)
+{
+    UPROFILE_INSTANCE_CALL(startFrameMonitoring, period, rawFrameTimes);
+}
+
+void startSelfMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startSelfMonitoring, period);
+}
+
+void startProcessIOMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startProcessIOMonitoring, period);
+}
+
+void startDiskIOMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startDiskIOMonitoring, period);
+}
+
+void startNetworkIOMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startNetworkIOMonitoring, period);
+}
+
+void startAffinityCPUUsageMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startAffinityCPUUsageMonitoring, period);
+}
+
+void startCgroupMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startCgroupMonitoring, period);
+}
+
+void startPressureMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startPressureMonitoring, period);
+}
+
+void startCPUFrequencyMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startCPUFrequencyMonitoring, period);
+}
+
+void startNumaMonitoring(int period)
+{
+    UPROFILE_INSTANCE_CALL(startNumaMonitoring, period);
+}
+
+void startThreadCPUMonitoring(int period, int topN)
+{
+    UPROFILE_INSTANCE_CALL(startThreadCPUMonitoring, period, topN);
+}
+
+void startProcessesMonitoring(int period, const std::vector<int>& pids)
+{
+    UPROFILE_INSTANCE_CALL(startProcessesMonitoring, period, pids, false);
+}
+
+void startProcessTreeMonitoring(int period, int rootPid)
+{
+    UPROFILE_INSTANCE_CALL(startProcessesMonitoring, period, {rootPid}, true);
+}
+
 void getProcessMemory(int& rss, int& shared)
 {
     UPROFILE_INSTANCE_CALL(getProcessMemory, rss, shared);
@@ -16,12 +16,21 @@
 #include <string>
 #include <vector>
 
+#include "activation.h"
+#include "adaptiverule.h"
 #include "api.h"
+#include "ieventsink.h"
 #include "igpumonitor.h"
+#include "imetricmonitor.h"
+#include "monitortype.h"
+#include "profiler.h"
 #include "timestampunit.h"
 
 /**
  * @defgroup uprofile Functions for monitoring system metrics
+ *
+ * The functions operate on a default profiler instance. Use uprofile::Profiler
+ * objects to record independent sets of events and metrics.
  *  @{
  */
 namespace uprofile
@@ -36,6 +45,13 @@ namespace uprofile
  *
  * If you have some storage constraints, set maxCapSize parameter for generating two rotating files (<file>_0.<ext> and <file>_1.<ext>)
  * Each file will have a maximum size of maxCapSize/2 (In this mode, more recent events will override older events)
+ *
+ * If filepath is NULL, no file is written: events are only handed to the sinks added with addSink().
+ *
+ * Events are written to the file (and to the sinks) by a writer thread, by batches handed every 100 ms or
+ * as soon as 64 KiB of events are pending: the events of the pending batch are lost if the process crashes
+ * (see enableFlightRecorder()). When the file or a sink does not keep up, the events exceeding 8 MiB pending
+ * for it are dropped and a 'dropped;<timestamp>;<count>' record is written to it instead.
  */
 UPROFAPI void start(const char* filepath, unsigned long long maxCapSize = 0);
 
@@ -52,16 +68,56 @@ UPROFAPI void stop();
  * @brief Inject a GPUMonitor object that will be responsible for monitoring GPU metrics (usage and memory)
  * @param monitor: custom GPUMonitor object
  *
+ * Several monitors can be injected (e.g. one per vendor): the GPUs of all of them are recorded,
+ * with the labels given by the monitors or numbered in the order the monitors were injected.
+ *
  * Note: uprofile takes ownership of the passed object.
  */
 UPROFAPI void addGPUMonitor(IGPUMonitor* monitor);
 
 /**
  * @ingroup uprofile
- * @brief Destroy injected GPUMonitor object
+ * @brief Destroy all the injected GPUMonitor objects
  */
 UPROFAPI void removeGPUMonitor();
 
+/**
+ * @ingroup uprofile
+ * @brief Periodically sample a custom metric monitor
+ * @param monitor: custom IMetricMonitor object (queue depths, cache hit rates...)
+ * @param period: sampling period in ms
+ *
+ * All the monitors are sampled from a single thread. A 'schema' event describing the
+ * fields of the monitor is recorded so that the samples can be displayed by show-graph.
+ *
+ * Note: uprofile takes ownership of the passed object. It is destroyed by removeMonitor() or stop().
+ */
+UPROFAPI void addMonitor(IMetricMonitor* monitor, int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Stop sampling and destroy a monitor added with addMonitor()
+ */
+UPROFAPI void removeMonitor(IMetricMonitor* monitor);
+
+/**
+ * @ingroup uprofile
+ * @brief Add a sink receiving the recorded events in addition to the file passed to start()
+ * @param sink: custom sink object or one of the sinks from the 'sinks' directory (memory ring, Unix socket, callback...)
+ * @param events: event types forwarded to the sink (like "cpu" or "time_exec"), all events if empty
+ *
+ * Events are encoded once and handed to the sinks by batches from a writer thread.
+ *
+ * Note: uprofile takes ownership of the passed object. Sinks are destroyed when calling stop().
+ */
+UPROFAPI void addSink(IEventSink* sink, const std::vector<std::string>& events = std::vector<std::string>());
+
+/**
+ * @ingroup uprofile
+ * @brief Flush and destroy a sink previously added with addSink()
+ */
+UPROFAPI void removeSink(IEventSink* sink);
+
 /**
  * @ingroup uprofile
  * @brief Change the timestamp unit to record profiling metrics
@@ -72,22 +128,357 @@ UPROFAPI void removeGPUMonitor();
  */
 UPROFAPI void setTimestampUnit(TimestampUnit tsUnit);
 
+/**
+ * @ingroup uprofile
+ * @brief Read the procfs and sysfs files of the monitors under another root directory
+ * @param root: directory holding 'proc' and 'sys' trees (e.g. synthetic files generated by tools/gen-sysroot),
+ *              empty for the running system
+ *
+ * It applies to the monitors started afterwards. The default root can also be set
+ * with the UPROFILE_SYSTEM_ROOT environment variable.
+ */
+UPROFAPI void setSystemRoot(const std::string& root);
+
+/**
+ * @ingroup uprofile
+ * @brief Aggregate monitored metrics into 1 s, 1 min and 1 h buckets
+ * @param keepRawSamples: whether each raw sample is still recorded
+ * @param rawRetention: if greater than 0, only the raw samples of the last rawRetention minutes are kept
+ *
+ * Each serie (CPU, memory, GPU) is aggregated in memory and a 'rollup' event holding
+ * the min, max, average and last values is recorded each time a bucket is complete.
+ * Partially filled buckets are recorded when calling stop().
+ *
+ * When a raw retention is set, raw samples are held in memory and only the most recent ones are
+ * saved when calling stop(). It keeps long captures small while having full resolution at the end.
+ */
+UPROFAPI void enableRollups(bool keepRawSamples = true, int rawRetention = 0);
+
+/**
+ * @ingroup uprofile
+ * @brief Only record the samples of a monitor when their values change
+ * @param monitor: monitor to apply the change detection to
+ * @param absThreshold: minimal absolute change of a value to record a sample
+ * @param relThreshold: minimal relative change of a value to record a sample (0.05 for 5%)
+ * @param heartbeat: maximum duration without any recorded sample (in ms), 0 to disable
+ *
+ * A sample is recorded if one of its values moves by more than one of the thresholds since the last
+ * recorded sample. If no threshold is set, any change is recorded. Readers should consider the
+ * metric as a step serie: a value holds until the next recorded sample.
+ */
+UPROFAPI void setDeadband(MonitorType monitor, double absThreshold, double relThreshold = 0., int heartbeat = 0);
+
+/**
+ * @ingroup uprofile
+ * @brief Temporarily sample monitors at a faster period when a condition is met
+ *
+ * For example, to sample CPU and process memory every 20 ms while a CPU is above 80%:
+ *
+ *     uprofile::AdaptiveRule rule;
+ *     rule.name = "cpu_spike";
+ *     rule.metric = "cpu";
+ *     rule.field = "usage";
+ *     rule.threshold = 80.;
+ *     rule.monitors = {uprofile::MonitorType::CPU, uprofile::MonitorType::PROCESS_MEMORY};
+ *     rule.fastPeriod = 20;
+ *     rule.window = 5000;
+ *
+ * Each period change is recorded as a 'period' event holding the monitor, its new period and the
+ * triggering rule (empty when going back to the base period).
+ */
+UPROFAPI void addAdaptiveRule(const AdaptiveRule& rule);
+
+/**
+ * @ingroup uprofile
+ * @brief Remove all adaptive rules and restore the base periods of the monitors
+ */
+UPROFAPI void clearAdaptiveRules();
+
+/**
+ * @ingroup uprofile
+ * @brief Start sampling the call stacks of all the threads of the process
+ * @param foldedPath: file receiving the folded stacks (flamegraph.pl, speedscope...) when calling stopStackSampling()
+ * @param frequency: samples per second of CPU time of each thread (CPU timers expire on kernel ticks, so
+ *        frequencies above CONFIG_HZ are not reached)
+ * @param maxDepth: maximum number of frames of a stack (128 at most)
+ *
+ * Threads are interrupted by SIGPROF according to the CPU time they consume and their stack is walked
+ * through frame pointers: code should be compiled with -fno-omit-frame-pointer. The span (timeBegin())
+ * active in the thread when sampled is the root frame of the stack ('[span]').
+ *
+ * Stack sampling is process-wide and independent of start()/stop().
+ *
+ * Note: only supported on Linux (x86_64 and aarch64)
+ */
+UPROFAPI void startStackSampling(const char* foldedPath, int frequency = 99, int maxDepth = 64);
+
+/**
+ * @ingroup uprofile
+ * @brief Stop sampling the call stacks and write the folded stacks file
+ */
+UPROFAPI void stopStackSampling();
+
+/**
+ * @ingroup uprofile
+ * @brief Record the calls of the functions compiled with -finstrument-functions
+ * @param minDuration: calls shorter than this duration (in us) are not recorded
+ *
+ * Each recorded call gives a 'func' event holding the location of the function in its module
+ * ('<module>+0x<offset>'), symbolized offline by show-graph. Code of the library is never instrumented.
+ * The recording stops with stop().
+ *
+ * Note: only supported on Linux, by a library built with -DFUNCTION_INSTRUMENTATION_ENABLED=ON
+ * (the hooks are not exported otherwise)
+ */
+UPROFAPI void startFunctionInstrumentation(unsigned int minDuration = 1000);
+
+/**
+ * @ingroup uprofile
+ * @brief Stop recording the calls of instrumented functions
+ */
+UPROFAPI void stopFunctionInstrumentation();
+
+/**
+ * @ingroup uprofile
+ * @brief Restrict the instrumented functions which are recorded
+ * @param includes: if not empty, only functions whose symbol or module contains one of these patterns are recorded
+ * @param excludes: functions whose symbol or module contains one of these patterns are not recorded
+ *
+ * Decisions are made once per function: filtered out calls cost a table lookup.
+ */
+UPROFAPI void setFunctionFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes = {});
+
+/**
+ * @ingroup uprofile
+ * @brief Keep the most recent events in a memory ring, saved to a file only when dumped
+ * @param dumpPath: path of the dump files, an index is appended to the file name ('crash.log' gives 'crash_0.log', 'crash_1.log'...)
+ * @param capacity: size of the ring (in bytes)
+ *
+ * Each event is copied into the ring when recorded, at the cost of a memory copy. Pass a null file
+ * path to start() to avoid any disk I/O until a dump. The ring is dumped by dumpFlightRecorder(), on
+ * a slow span (setFlightRecorderLatencyTrigger()) or on a signal (enableFlightRecorderSignal(),
+ * enableFlightRecorderCrashDump()).
+ */
+UPROFAPI void enableFlightRecorder(const char* dumpPath, size_t capacity = 4 * 1024 * 1024);
+
+/**
+ * @ingroup uprofile
+ * @brief Save the flight recorder ring to a new dump file
+ * @return whether the dump file has been written
+ */
+UPROFAPI bool dumpFlightRecorder();
+
+/**
+ * @ingroup uprofile
+ * @brief Dump the flight recorder when a span (timeBegin()/timeEnd()) lasts at least the given duration
+ * @param threshold: span duration (in ms), 0 to disable
+ *
+ * At most one dump is triggered per second. The dump is written shortly after timeEnd() by the monitoring
+ * thread of the profiler, not by the calling thread.
+ */
+UPROFAPI void setFlightRecorderLatencyTrigger(unsigned long long threshold);
+
+/**
+ * @ingroup uprofile
+ * @brief Dump the flight recorders of the process each time the given signal (like SIGUSR1) is received
+ *
+ * Note: only supported on Linux
+ */
+UPROFAPI void enableFlightRecorderSignal(int signum);
+
+/**
+ * @ingroup uprofile
+ * @brief Dump the flight recorders of the process when it crashes (SIGSEGV, SIGABRT, SIGBUS, SIGFPE or SIGILL)
+ *
+ * The dump is written from the signal handler with async-signal-safe calls only, then the default
+ * action of the signal (core dump) happens. It replaces the handlers previously installed for these signals.
+ *
+ * Note: only supported on Linux
+ */
+UPROFAPI void enableFlightRecorderCrashDump();
+
+/**
+ * @ingroup uprofile
+ * @brief Enable or disable the recording of instrumented events at runtime
+ *
+ * Profiling is enabled by default (unless UPROFILE_ENABLED environment variable is set to 0).
+ * Instrumentation calls (like timeBegin() and timeEnd()) cost a single atomic load when disabled.
+ * Monitorings are not affected.
+ */
+UPROFAPI void setEnabled(bool enabled);
+
+/**
+ * @ingroup uprofile
+ * @brief Select the categories of instrumented events to record
+ * @param categories: mask of categories (all categories by default, or the UPROFILE_CATEGORIES environment variable value)
+ */
+UPROFAPI void setCategories(unsigned long long categories);
+
+/**
+ * @ingroup uprofile
+ * @brief Toggle the recording of instrumented events each time the given signal (like SIGUSR2) is received
+ *
+ * Note: only supported on Linux
+ */
+UPROFAPI void enableSignalToggle(int signum);
+
+namespace detail
+{
+UPROFAPI void timeBegin(const std::string& title);
+UPROFAPI void timeEnd(const std::string& title);
+UPROFAPI void counterAdd(const std::string& name, long long delta);
+UPROFAPI void gaugeSet(const std::string& name, double value);
+UPROFAPI void histogramRecord(const std::string& name, double value);
+UPROFAPI void markFrame(const std::string& channel);
+}
+
 /**
  * @ingroup uprofile
  * @brief Start monitoring the execution time of the given event
  * @param title: event key
+ * @param category: category of the event (see setCategories())
+ *
+ * The call is ignored if profiling is not started, disabled or the category is not recorded.
  */
-UPROFAPI void timeBegin(const std::string& title);
+inline void timeBegin(const std::string& title, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::timeBegin(title);
+    }
+}
 
 /**
  * @ingroup uprofile
  * @brief Stop monitoring the execution time of the given event
+ * @param title: event key
+ * @param category: category of the event (see setCategories())
  *
  * The library computes the duration for the given event and saves it into the report file.
  *
  * If no timeBegin() has been called with the given title, the call is ignored.
  */
-UPROFAPI void timeEnd(const std::string& title);
+inline void timeEnd(const std::string& title, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::timeEnd(title);
+    }
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Add a value to an application counter
+ * @param name: counter key
+ * @param delta: value to add
+ * @param category: category of the counter (see setCategories())
+ *
+ * Counters are stored per thread so incrementing a counter is an uncontended thread-local add.
+ * Values are aggregated and saved by startCountersMonitoring().
+ */
+inline void counterAdd(const std::string& name, long long delta = 1, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::counterAdd(name, delta);
+    }
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Set the current value of an application gauge
+ * @param name: gauge key
+ * @param value: new value (the most recent value set by any thread is saved)
+ * @param category: category of the gauge (see setCategories())
+ */
+inline void gaugeSet(const std::string& name, double value, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::gaugeSet(name, value);
+    }
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Record a value into an application histogram
+ * @param name: histogram key
+ * @param value: positive value (like a latency or a size)
+ * @param category: category of the histogram (see setCategories())
+ *
+ * Count, average and percentiles (estimated within 12.5%) of the values recorded during each period are saved.
+ */
+inline void histogramRecord(const std::string& name, double value, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::histogramRecord(name, value);
+    }
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Mark the end of a frame (or of an iteration of a loop) of the given channel
+ * @param channel: channel key (like "video" or "ui")
+ * @param category: category of the channel (see setCategories())
+ *
+ * The time elapsed since the previous mark of the channel is recorded into lock-free per-channel
+ * statistics saved by startFrameMonitoring().
+ */
+inline void markFrame(const std::string& channel, unsigned long long category = DEFAULT_CATEGORY)
+{
+    if (isEnabled(category)) {
+        detail::markFrame(channel);
+    }
+}
+
+/**
+ * @ingroup uprofile
+ * @brief Set the expected frame rate of a channel
+ * @param channel: channel key
+ * @param fps: expected frames per second (0 to disable)
+ *
+ * A frame lasting more than 1.5 periods counts the skipped periods as missed deadlines.
+ */
+UPROFAPI void setFrameRate(const std::string& channel, double fps);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the frame pacing of the channels
+ * @param period: period between two dumps (in ms)
+ * @param rawFrameTimes: whether the time of each frame is also saved
+ *
+ * For each channel marked during the period, the frame rate, the number of frames, the average,
+ * p50, p99 and max frame times (in ms), the jitter (standard deviation of the frame times, in ms)
+ * and the missed deadlines are saved.
+ */
+UPROFAPI void startFrameMonitoring(int period, bool rawFrameTimes = false);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring the overhead of the profiler itself
+ * @param period: period between two dumps (in ms)
+ *
+ * An 'uprofile_self' event is saved each period with the CPU time of the monitoring and writer threads (in ms),
+ * the time spent in timeBegin()/timeEnd() and in writing events (in us), the number and size of the events
+ * written, the time waited by the producers of events for the lock of the event batches (in us), the events
+ * dropped because a sink does not keep up and the samples filtered out (deadband, rollups).
+ *
+ * Times are measured with two clock reads added to striped counters, cheap enough to stay enabled.
+ */
+UPROFAPI void startSelfMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the application counters, gauges and histograms
+ * @param period: period between two dumps (in ms)
+ */
+UPROFAPI void startCountersMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring the contention of the profiled locks (see profiledmutex.h)
+ * @param period: period between two dumps (in ms)
+ *
+ * For each lock name used during the period, the number of acquisitions, of contended acquisitions
+ * and the percentiles of the wait and hold times (in us) are saved.
+ */
+UPROFAPI void startLockMonitoring(int period);
 
 /**
  * @ingroup uprofile
@@ -124,6 +515,108 @@ UPROFAPI void startGPUUsageMonitoring(int period);
  */
 UPROFAPI void startGPUMemoryMonitoring(int period);
 
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the I/O of the process (KiB/s read and written to storage and through syscalls, syscalls/s)
+ * @param period: period between two I/O dump (in ms)
+ */
+UPROFAPI void startProcessIOMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the throughput (KiB/s), IOPS and utilization (%) of each block device
+ * @param period: period between two I/O dump (in ms)
+ */
+UPROFAPI void startDiskIOMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the throughput (KiB/s), packets and drops per second of each network interface
+ * @param period: period between two I/O dump (in ms)
+ */
+UPROFAPI void startNetworkIOMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the usage percentage of the CPUs the process can run on (affinity mask and cgroup cpuset)
+ * @param period: period between two cpu usage dump (in ms)
+ *
+ * Replaces the monitoring started by startCPUUsageMonitoring(): both record 'cpu' events.
+ */
+UPROFAPI void startAffinityCPUUsageMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the CPU usage, throttling and memory of the cgroup v2 of the process (see CgroupMonitor)
+ * @param period: period between two cgroup dump (in ms)
+ *
+ * Unlike the system memory and CPU monitors, it reflects the limits of the container the process runs in.
+ */
+UPROFAPI void startCgroupMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the pressure stall information of the CPU, memory and I/O (see PressureMonitor)
+ * @param period: period between two pressure dump (in ms)
+ */
+UPROFAPI void startPressureMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the current and maximum frequency (in MHz) of each CPU (cpufreq)
+ * @param period: period between two frequency dump (in ms)
+ *
+ * A current frequency below the maximum one under load reveals throttling.
+ * The CPU topology is written once at the start of the capture: one 'topology' event per CPU with its
+ * package (socket), core, NUMA node and SMT siblings so that the CPUs can be grouped.
+ */
+UPROFAPI void startCPUFrequencyMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the memory of each NUMA node and of the memory of the process on each node
+ * @param period: period between two NUMA dump (in ms)
+ *
+ * Records 'numa_mem' events (total, free, used, file and anonymous memory of the node in KiB) and
+ * 'proc_numa' events (total, anonymous and file memory of the process on the node in KiB, read from
+ * /proc/self/numa_maps whose reading is costly: prefer periods of a second or more).
+ * The CPU topology is written at the start of the capture like with startCPUFrequencyMonitoring().
+ */
+UPROFAPI void startNumaMonitoring(int period);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the CPU usage of each thread of the process
+ * @param period: period between two thread usage dump (in ms)
+ * @param topN: only record the N most consuming threads of each period (all threads if 0)
+ *
+ * Records 'thread' events with the thread id, its name, its usage (in % of one CPU),
+ * the CPU it last ran on and its state.
+ */
+UPROFAPI void startThreadCPUMonitoring(int period, int topN = 0);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of the memory and CPU usage of other processes (like spawned workers)
+ * @param period: period between two processes dump (in ms)
+ * @param pids: PIDs of the monitored processes
+ *
+ * Records 'process' events with the PID, the command name, the CPU usage (in % of one CPU),
+ * the RSS and PSS memory (in KiB) and the number of threads of each process.
+ * A process is no longer monitored once it has exited.
+ */
+UPROFAPI void startProcessesMonitoring(int period, const std::vector<int>& pids);
+
+/**
+ * @ingroup uprofile
+ * @brief Start monitoring of a process and all its descendants (see startProcessesMonitoring())
+ * @param period: period between two processes dump (in ms)
+ * @param rootPid: root process of the monitored tree (the current process if 0)
+ *
+ * Processes created or exited between two periods are discovered or forgotten at each period.
+ */
+UPROFAPI void startProcessTreeMonitoring(int period, int rootPid = 0);
+
 /**
  * @ingroup uprofile
  * @brief memory used by the current process
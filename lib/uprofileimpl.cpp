@@ -7,18 +7,32 @@
 //
 // Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 
 #if defined(__linux__)
 #include <sys/sysinfo.h>
-#include <unistd.h>
 #elif defined(_WIN32)
 #include <windows.h>
 #endif
 
+#include "activationimpl.h"
+#include "counters.h"
+#include "monitors/cgroupmonitor.h"
+#include "monitors/cpuusagemonitor.h"
+#include "monitors/iomonitors.h"
+#include "monitors/memorymonitor.h"
+#include "monitors/pressuremonitor.h"
+#include "monitors/topologymonitors.h"
+#include "sinks/filesink.h"
+#include "util/cputopology.h"
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+#include "util/functioninstrumentation.h"
+#endif
+#include "util/stacksampler.h"
 #include "uprofileimpl.h"
 
 using namespace std::chrono;
@@ -26,35 +40,98 @@ using namespace std::chrono;
 namespace uprofile
 {
 
-UProfileImpl* UProfileImpl::m_uprofiler = NULL;
+static const std::vector<std::string> USAGE_FIELDS = {"usage"};
+static const std::vector<std::string> GPU_MEM_FIELDS = {"used", "total"};
+static const std::vector<std::string> COUNTER_FIELDS = {"total", "delta"};
+static const std::vector<std::string> GAUGE_FIELDS = {"value"};
+static const std::vector<std::string> HISTOGRAM_FIELDS = {"count", "avg", "p50", "p90", "p99", "max"};
+static const std::vector<std::string> FRAME_FIELDS = {"fps", "frames", "avg", "p50", "p99", "max", "jitter", "missed"};
+static const std::vector<std::string> SELF_FIELDS = {"cpu_ms", "api_us", "write_us", "events", "bytes", "lock_wait_us", "dropped", "filtered"};
+static const std::vector<std::string> LOCK_FIELDS = {"acquisitions", "contended", "wait_p50", "wait_p99", "wait_max", "hold_p50", "hold_p99", "hold_max"};
+static const unsigned long long TRIGGERED_DUMP_INTERVAL = 1000; // ms between two dumps triggered by slow spans
+static const char* const TRIGGERED_DUMP_TASK = "flight_recorder_dump"; // one-shot task of the scheduler
+
+std::atomic<UProfileImpl*> UProfileImpl::m_uprofiler(NULL);
+std::mutex UProfileImpl::m_instanceMutex;
 UProfileImpl::UProfileImpl() :
     m_tsUnit(TimestampUnit::EPOCH_TIME),
-    m_gpuMonitor(NULL)
+    m_started(false),
+    m_dumpLatency(0),
+    m_lastTriggeredDump(0),
+    m_adaptive(m_scheduler, [this](const std::string& monitor, int period, const std::string& rule) {
+        write(ProfilingType::PERIOD, {monitor, std::to_string(period), rule});
+    }),
+    m_threadTopN(0),
+    m_selfMonitoring(false),
+    m_recordTopology(false),
+    m_topologyWritten(false)
 {
 }
 
 UProfileImpl* UProfileImpl::getInstance()
 {
-    if (!m_uprofiler) {
-        m_uprofiler = new UProfileImpl;
+    // Only lock when the instance has to be created
+    UProfileImpl* instance = m_uprofiler;
+    if (!instance) {
+        std::lock_guard<std::mutex> guard(m_instanceMutex);
+        instance = m_uprofiler;
+        if (!instance) {
+            instance = new UProfileImpl;
+            m_uprofiler = instance;
+        }
     }
-    return m_uprofiler;
+    return instance;
 }
 
 void UProfileImpl::destroyInstance()
 {
-    delete m_uprofiler;
-    m_uprofiler = NULL;
+    std::lock_guard<std::mutex> guard(m_instanceMutex);
+    delete m_uprofiler.exchange(NULL);
 }
 
 UProfileImpl::~UProfileImpl()
 {
+    m_scheduler.clear();
+    m_writer.setRecorder(nullptr);
     removeGPUMonitor();
 }
 
 void UProfileImpl::start(const char* filepath, unsigned long long maxCapSize)
 {
-    m_file = make_shared<EventsFile>(filepath, maxCapSize);
+    std::unique_lock<std::mutex> selfLock(m_selfMutex);
+    if (m_fileSink) {
+        m_writer.removeSink(m_fileSink);
+        m_fileSink = nullptr;
+    }
+    if (filepath) {
+        m_fileSink = new FileSink(filepath, maxCapSize);
+        m_writer.addSink(m_fileSink, {});
+    }
+    selfLock.unlock();
+    if (!m_started.exchange(true)) {
+        Activation::profilerStarted();
+    }
+
+    // Let readers group the CPUs of the CPU metrics
+    m_topologyWritten = false;
+    if (m_recordTopology) {
+        writeTopology();
+    }
+
+    // Let readers know which metrics are recorded only on change
+    std::unique_lock<std::mutex> lk(m_deadbandsMutex);
+    for (auto it = m_deadbands.cbegin(); it != m_deadbands.cend(); ++it) {
+        writeDeadband(it->first, *it->second);
+    }
+    lk.unlock();
+
+    // and how to read the custom metrics already monitored
+    std::lock_guard<std::mutex> guard(m_monitorsMutex);
+    for (auto it = m_monitors.cbegin(); it != m_monitors.cend(); ++it) {
+        if (it->second->custom) {
+            writeSchema(it->second->schema);
+        }
+    }
 }
 
 void UProfileImpl::addGPUMonitor(IGPUMonitor* monitor)
@@ -64,27 +141,148 @@ void UProfileImpl::addGPUMonitor(IGPUMonitor* monitor)
         return;
     }
 
-    removeGPUMonitor();
-
-    m_gpuMonitor = monitor;
+    // Monitors of several vendors or drivers can be used together
+    std::lock_guard<std::mutex> guard(m_gpuMonitorsMutex);
+    m_gpuMonitors.push_back(std::unique_ptr<IGPUMonitor>(monitor));
 }
 
 void UProfileImpl::removeGPUMonitor()
 {
-    if (m_gpuMonitor) {
-        delete m_gpuMonitor;
-        m_gpuMonitor = NULL;
+    std::lock_guard<std::mutex> guard(m_gpuMonitorsMutex);
+    m_gpuMonitors.clear();
+}
+
+void UProfileImpl::addMonitor(IMetricMonitor* monitor, int period)
+{
+    if (!monitor) {
+        std::cerr << "Invalid metric monitor" << std::endl;
+        return;
+    }
+    startMonitor(monitor, period, true);
+}
+
+void UProfileImpl::removeMonitor(IMetricMonitor* monitor)
+{
+    std::lock_guard<std::mutex> guard(m_monitorsMutex);
+    for (auto it = m_monitors.begin(); it != m_monitors.end(); ++it) {
+        if (it->second->monitor.get() == monitor) {
+            m_scheduler.remove(it->first);
+            m_monitors.erase(it);
+            return;
+        }
+    }
+}
+
+void UProfileImpl::startMonitor(IMetricMonitor* monitor, int period, bool custom)
+{
+    if (period <= 0) {
+        std::cerr << "Invalid monitoring period: " << period << std::endl;
+        delete monitor;
+        return;
     }
+
+    MonitorEntry* entry = new MonitorEntry;
+    entry->monitor.reset(monitor);
+    entry->schema = monitor->schema();
+    entry->values.resize(std::max<size_t>(entry->schema.instances.size(), 1) * entry->schema.fields.size(), 0.);
+    entry->custom = custom;
+
+    std::lock_guard<std::mutex> guard(m_monitorsMutex);
+    const std::string& name = entry->schema.name;
+    // A monitor replaces the previous one with the same name
+    m_scheduler.remove(name);
+    m_monitors[name].reset(entry);
+    if (custom && m_started) {
+        writeSchema(entry->schema);
+    }
+    m_scheduler.schedule(name, period, [=]() {
+        sampleMonitor(*entry);
+    });
+}
+
+void UProfileImpl::sampleMonitor(MonitorEntry& entry)
+{
+    if (entry.values.empty()) {
+        return;
+    }
+
+    entry.monitor->sample(&entry.values[0]);
+    const MetricSchema& schema = entry.schema;
+    if (schema.instances.empty()) {
+        writeMetric(schema.name, "", schema.fields, &entry.values[0]);
+        return;
+    }
+    for (size_t i = 0; i < schema.instances.size(); ++i) {
+        writeMetric(schema.name, schema.instances[i], schema.fields, &entry.values[i * schema.fields.size()]);
+    }
+}
+
+void UProfileImpl::writeSchema(const MetricSchema& schema)
+{
+    std::list<std::string> data = {schema.name, schema.instances.empty() ? "0" : "1"};
+    data.insert(data.end(), schema.fields.begin(), schema.fields.end());
+    write(ProfilingType::SCHEMA, data);
+}
+
+void UProfileImpl::recordTopology()
+{
+    m_recordTopology = true;
+    if (m_started) {
+        writeTopology();
+    }
+}
+
+void UProfileImpl::writeTopology()
+{
+    if (m_topologyWritten.exchange(true)) {
+        return;
+    }
+    std::vector<CpuTopology::Cpu> cpus = CpuTopology::read();
+    for (auto it = cpus.cbegin(); it != cpus.cend(); ++it) {
+        write(ProfilingType::TOPOLOGY, {std::to_string(it->index), std::to_string(it->package), std::to_string(it->core),
+                                        std::to_string(it->node), it->siblings});
+    }
+}
+
+void UProfileImpl::addSink(IEventSink* sink, const std::vector<std::string>& events)
+{
+    if (!sink) {
+        std::cerr << "Invalid event sink" << std::endl;
+        return;
+    }
+    m_writer.addSink(sink, events);
+}
+
+void UProfileImpl::removeSink(IEventSink* sink)
+{
+    m_writer.removeSink(sink);
 }
 
 void UProfileImpl::timeBegin(const std::string& title)
 {
-    std::lock_guard<std::mutex> guard(m_stepsMutex);
+    if (!m_started) {
+        return;
+    }
+    unsigned long long begin = m_selfMonitoring.load(std::memory_order_relaxed) ? SelfStats::now() : 0;
+
+    StackSampler::instance().pushSpan(title);
+    std::unique_lock<std::mutex> lk(m_stepsMutex);
     m_steps.insert(make_pair(title, getTimestamp()));
+    lk.unlock();
+
+    if (begin > 0) {
+        m_selfStats.add(SelfStats::API_TIME, SelfStats::now() - begin);
+    }
 }
 
 void UProfileImpl::timeEnd(const std::string& title)
 {
+    if (!m_started) {
+        return;
+    }
+    unsigned long long begin = m_selfMonitoring.load(std::memory_order_relaxed) ? SelfStats::now() : 0;
+
+    StackSampler::instance().popSpan(title);
     unsigned long long beginTimestamp = 0;
 
     // Find step in the map
@@ -98,136 +296,462 @@ void UProfileImpl::timeEnd(const std::string& title)
     lk.unlock();
 
     if (found) {
-        write(ProfilingType::TIME_EXEC, {std::to_string(beginTimestamp), title});
+        unsigned long long timestamp = getTimestamp();
+        write(ProfilingType::TIME_EXEC, timestamp, {std::to_string(beginTimestamp), title});
+        m_adaptive.onSpan(title, timestamp - beginTimestamp);
+        unsigned long long threshold = m_dumpLatency;
+        if (threshold > 0 && timestamp - beginTimestamp >= threshold) {
+            // Slow span: save what led to it (at most one triggered dump per interval). The file
+            // is written by the scheduler thread, not by the thread of the application
+            unsigned long long now = getEpochTime();
+            unsigned long long last = m_lastTriggeredDump;
+            if (now - last >= TRIGGERED_DUMP_INTERVAL && m_lastTriggeredDump.compare_exchange_strong(last, now)) {
+                m_scheduler.schedule(TRIGGERED_DUMP_TASK, 1, [this]() {
+                    m_scheduler.remove(TRIGGERED_DUMP_TASK);
+                    dumpFlightRecorder();
+                });
+            }
+        }
     } else {
         write(ProfilingType::TIME_EVENT, {title});
     }
+
+    if (begin > 0) {
+        m_selfStats.add(SelfStats::API_TIME, SelfStats::now() - begin);
+    }
 }
 
 void UProfileImpl::startProcessMemoryMonitoring(int period)
 {
-    m_processMemoryMonitorTimer.setInterval(period);
-    m_processMemoryMonitorTimer.setTimeout([=]() {
-        dumpProcessMemory();
-    });
-    m_processMemoryMonitorTimer.start();
+    // Only change the period of a running monitor
+    if (!m_scheduler.setPeriod(getTypeName(ProfilingType::PROCESS_MEMORY), period)) {
+        startMonitor(new ProcessMemoryMonitor, period, false);
+    }
 }
 
 void UProfileImpl::startSystemMemoryMonitoring(int period)
 {
-    m_systemMemoryMonitorTimer.setInterval(period);
-    m_systemMemoryMonitorTimer.setTimeout([=]() {
-        dumpSystemMemory();
-    });
-    m_systemMemoryMonitorTimer.start();
+    if (!m_scheduler.setPeriod(getTypeName(ProfilingType::SYSTEM_MEMORY), period)) {
+        startMonitor(new SystemMemoryMonitor, period, false);
+    }
 }
 
 void UProfileImpl::startCPUUsageMonitoring(int period)
 {
-    m_cpuMonitorTimer.setInterval(period);
-    m_cpuMonitorTimer.setTimeout([=]() {
-        dumpCpuUsage();
-    });
-    m_cpuMonitorTimer.start();
+    if (!m_scheduler.setPeriod(getTypeName(ProfilingType::CPU), period)) {
+        startMonitor(new CpuUsageMonitor, period, false);
+    }
 }
 
-void UProfileImpl::startGPUUsageMonitoring(int period)
+void UProfileImpl::startCPUFrequencyMonitoring(int period)
 {
-    if (!m_gpuMonitor) {
-        std::cerr << "Cannot monitor GPU usage: no GPUMonitor set!" << std::endl;
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::CPU_FREQUENCY), period)) {
+        return;
+    }
+    CpuFrequencyMonitor* monitor = new CpuFrequencyMonitor;
+    if (monitor->schema().instances.empty()) {
+        std::cerr << "Cannot monitor CPU frequency: no cpufreq information available!" << std::endl;
+        delete monitor;
+        return;
+    }
+    recordTopology();
+    startMonitor(monitor, period, false);
+}
+
+void UProfileImpl::startNumaMonitoring(int period)
+{
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::NUMA_MEMORY), period)) {
+        m_scheduler.setPeriod(getTypeName(ProfilingType::PROCESS_NUMA), period);
+        return;
+    }
+    NumaMemoryMonitor* monitor = new NumaMemoryMonitor;
+    if (monitor->schema().instances.empty()) {
+        std::cerr << "Cannot monitor NUMA memory: no NUMA node found!" << std::endl;
+        delete monitor;
         return;
     }
+    recordTopology();
+    startMonitor(monitor, period, false);
 
-    m_gpuMonitor->start(period);
+    // Pages of the process on each node, if numa_maps is available
+    ProcessNumaMonitor* processMonitor = new ProcessNumaMonitor;
+    if (processMonitor->schema().instances.empty()) {
+        delete processMonitor;
+        return;
+    }
+    startMonitor(processMonitor, period, false);
+}
 
-    m_gpuUsageMonitorTimer.setInterval(period);
-    m_gpuUsageMonitorTimer.setTimeout([=]() {
+void UProfileImpl::startGPUUsageMonitoring(int period)
+{
+    if (!startGPUMonitors(period)) {
+        std::cerr << "Cannot monitor GPU usage: no GPUMonitor set!" << std::endl;
+        return;
+    }
+    m_scheduler.schedule(getTypeName(ProfilingType::GPU_USAGE), period, [=]() {
         dumpGpuUsage();
     });
-    m_gpuUsageMonitorTimer.start();
 }
 
 void UProfileImpl::startGPUMemoryMonitoring(int period)
 {
-    if (!m_gpuMonitor) {
+    if (!startGPUMonitors(period)) {
         std::cerr << "Cannot monitor GPU memory: no GPUMonitor set!" << std::endl;
         return;
     }
-    m_gpuMonitor->start(period);
-
-    m_gpuMemoryMonitorTimer.setInterval(period);
-    m_gpuMemoryMonitorTimer.setTimeout([=]() {
+    m_scheduler.schedule(getTypeName(ProfilingType::GPU_MEMORY), period, [=]() {
         dumpGpuMemory();
     });
-    m_gpuMemoryMonitorTimer.start();
 }
 
-void UProfileImpl::dumpProcessMemory()
+void UProfileImpl::startCountersMonitoring(int period)
 {
-    int rss = 0, shared = 0;
-    getProcessMemory(rss, shared);
-    write(ProfilingType::PROCESS_MEMORY, {std::to_string(rss), std::to_string(shared)});
+    m_scheduler.schedule(getTypeName(ProfilingType::COUNTER), period, [=]() {
+        dumpCounters();
+    });
 }
 
-void UProfileImpl::dumpSystemMemory()
+void UProfileImpl::startLockMonitoring(int period)
 {
-    int total = 0, available = 0, free = 0;
-    getSystemMemory(total, available, free);
-    write(ProfilingType::SYSTEM_MEMORY, {std::to_string(total), std::to_string(available), std::to_string(free)});
+    m_scheduler.schedule(getTypeName(ProfilingType::LOCK), period, [=]() {
+        dumpLocks();
+    });
 }
 
-void UProfileImpl::dumpCpuUsage()
+void UProfileImpl::startFrameMonitoring(int period, bool rawFrameTimes)
 {
-    vector<float> cpuLoads = m_cpuMonitor.getUsage();
-    for (size_t index = 0; index < cpuLoads.size(); ++index) {
-        write(ProfilingType::CPU, {std::to_string(index), std::to_string(cpuLoads.at(index))});
+    FrameTracker::instance().setRawFrames(rawFrameTimes);
+    m_scheduler.schedule(getTypeName(ProfilingType::FRAME), period, [=]() {
+        dumpFrames(rawFrameTimes);
+    });
+}
+
+void UProfileImpl::startSelfMonitoring(int period)
+{
+    m_selfMonitoring = true;
+    m_writer.setSelfStats(&m_selfStats);
+    m_scheduler.schedule(getTypeName(ProfilingType::SELF), period, [=]() {
+        dumpSelf();
+    });
+}
+
+void UProfileImpl::startProcessIOMonitoring(int period)
+{
+    if (!m_scheduler.setPeriod(getTypeName(ProfilingType::PROCESS_IO), period)) {
+        startMonitor(new ProcessIOMonitor, period, false);
     }
 }
 
-void UProfileImpl::dumpGpuUsage()
+void UProfileImpl::startDiskIOMonitoring(int period)
+{
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::DISK_IO), period)) {
+        return;
+    }
+    DiskIOMonitor* monitor = new DiskIOMonitor;
+    if (monitor->schema().instances.empty()) {
+        std::cerr << "Cannot monitor disk I/O: no block device found!" << std::endl;
+        delete monitor;
+        return;
+    }
+    startMonitor(monitor, period, false);
+}
+
+void UProfileImpl::startNetworkIOMonitoring(int period)
 {
-    if (!m_gpuMonitor || !m_gpuMonitor->watching()) {
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::NETWORK_IO), period)) {
+        return;
+    }
+    NetworkIOMonitor* monitor = new NetworkIOMonitor;
+    if (monitor->schema().instances.empty()) {
+        std::cerr << "Cannot monitor network I/O: no network interface found!" << std::endl;
+        delete monitor;
         return;
     }
+    startMonitor(monitor, period, false);
+}
+
+void UProfileImpl::startAffinityCPUUsageMonitoring(int period)
+{
+    // Replaces the monitor of all the cores if any
+    startMonitor(new CpuUsageMonitor(true), period, false);
+}
 
-    auto const& usage = m_gpuMonitor->getUsage();
-    for (size_t i = 0; i < usage.size(); ++i) {
-        write(ProfilingType::GPU_USAGE, {std::to_string(i), std::to_string(usage[i])});
+void UProfileImpl::startCgroupMonitoring(int period)
+{
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::CGROUP), period)) {
+        return;
     }
+    CgroupMonitor* monitor = new CgroupMonitor;
+    if (monitor->directory().empty()) {
+        std::cerr << "Cannot monitor cgroup: process is not in a cgroup v2 hierarchy!" << std::endl;
+        delete monitor;
+        return;
+    }
+    startMonitor(monitor, period, false);
 }
 
-void UProfileImpl::dumpGpuMemory()
+void UProfileImpl::startPressureMonitoring(int period)
 {
-    if (!m_gpuMonitor || !m_gpuMonitor->watching()) {
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::PRESSURE), period)) {
         return;
     }
+    PressureMonitor* monitor = new PressureMonitor;
+    if (monitor->schema().instances.empty()) {
+        std::cerr << "Cannot monitor pressure: no pressure stall information available!" << std::endl;
+        delete monitor;
+        return;
+    }
+    startMonitor(monitor, period, false);
+}
 
-    vector<int> usedMems, totalMems;
-    m_gpuMonitor->getMemory(usedMems, totalMems);
-    for (size_t i = 0; i < usedMems.size(); ++i) {
-        write(ProfilingType::GPU_MEMORY, {std::to_string(i), std::to_string(usedMems[i]), std::to_string(totalMems[i])});
+void UProfileImpl::startThreadCPUMonitoring(int period, int topN)
+{
+    m_threadTopN = topN > 0 ? topN : 0;
+    if (m_scheduler.setPeriod(getTypeName(ProfilingType::THREAD), period)) {
+        return;
+    }
+    m_threadMonitor.reset(new ThreadMonitor);
+    m_scheduler.schedule(getTypeName(ProfilingType::THREAD), period, [=]() {
+        dumpThreadUsage();
+    });
+}
+
+void UProfileImpl::startProcessesMonitoring(int period, const std::vector<int>& pids, bool descendants)
+{
+    // A single task samples all the processes
+    m_scheduler.remove(getTypeName(ProfilingType::PROCESS));
+    m_processMonitor.reset(new ProcessMonitor(pids, descendants));
+    m_scheduler.schedule(getTypeName(ProfilingType::PROCESS), period, [=]() {
+        dumpProcessesUsage();
+    });
+}
+
+bool UProfileImpl::startGPUMonitors(int period)
+{
+    std::lock_guard<std::mutex> guard(m_gpuMonitorsMutex);
+    for (auto it = m_gpuMonitors.cbegin(); it != m_gpuMonitors.cend(); ++it) {
+        (*it)->start(period);
+    }
+    return !m_gpuMonitors.empty();
+}
+
+std::string UProfileImpl::getGpuName(const std::vector<std::string>& names, size_t index, size_t number)
+{
+    // Unlabelled GPUs are numbered after the GPUs of the previous monitors
+    return index < names.size() ? names[index] : std::to_string(number);
+}
+
+void UProfileImpl::dumpGpuUsage()
+{
+    std::lock_guard<std::mutex> guard(m_gpuMonitorsMutex);
+    size_t number = 0;
+    for (auto it = m_gpuMonitors.cbegin(); it != m_gpuMonitors.cend(); ++it) {
+        IGPUMonitor& monitor = **it;
+        if (!monitor.watching()) {
+            continue;
+        }
+        std::vector<std::string> names = monitor.getNames();
+        auto const& usage = monitor.getUsage();
+        for (size_t i = 0; i < usage.size(); ++i, ++number) {
+            double value = usage[i];
+            writeMetric(getTypeName(ProfilingType::GPU_USAGE), getGpuName(names, i, number), USAGE_FIELDS, &value);
+        }
+    }
+}
+
+void UProfileImpl::dumpGpuMemory()
+{
+    std::lock_guard<std::mutex> guard(m_gpuMonitorsMutex);
+    size_t number = 0;
+    for (auto it = m_gpuMonitors.cbegin(); it != m_gpuMonitors.cend(); ++it) {
+        IGPUMonitor& monitor = **it;
+        if (!monitor.watching()) {
+            continue;
+        }
+        std::vector<std::string> names = monitor.getNames();
+        vector<int> usedMems, totalMems;
+        monitor.getMemory(usedMems, totalMems);
+        for (size_t i = 0; i < usedMems.size() && i < totalMems.size(); ++i, ++number) {
+            double values[] = {double(usedMems[i]), double(totalMems[i])};
+            writeMetric(getTypeName(ProfilingType::GPU_MEMORY), getGpuName(names, i, number), GPU_MEM_FIELDS, values);
+        }
+    }
+}
+
+void UProfileImpl::dumpCounters()
+{
+    CounterRegistry::Snapshot snapshot = CounterRegistry::instance().collect();
+    for (auto it = snapshot.counters.cbegin(); it != snapshot.counters.cend(); ++it) {
+        long long& last = m_lastCounters[it->first];
+        double values[] = {double(it->second), double(it->second - last)};
+        writeMetric(getTypeName(ProfilingType::COUNTER), it->first, COUNTER_FIELDS, values);
+        last = it->second;
+    }
+    for (auto it = snapshot.gauges.cbegin(); it != snapshot.gauges.cend(); ++it) {
+        writeMetric(getTypeName(ProfilingType::GAUGE), it->first, GAUGE_FIELDS, &it->second);
+    }
+    for (auto it = snapshot.histograms.cbegin(); it != snapshot.histograms.cend(); ++it) {
+        // Histograms are recorded for the last period only
+        Histogram& last = m_lastHistograms[it->first];
+        Histogram period = it->second.since(last);
+        double values[] = {double(period.count()), period.average(), period.percentile(50.), period.percentile(90.), period.percentile(99.), period.max()};
+        writeMetric(getTypeName(ProfilingType::HISTOGRAM), it->first, HISTOGRAM_FIELDS, values);
+        last = it->second;
+    }
+}
+
+void UProfileImpl::dumpLocks()
+{
+    std::map<std::string, LockRegistry::Snapshot> locks = LockRegistry::instance().collect();
+    for (auto it = locks.cbegin(); it != locks.cend(); ++it) {
+        // Statistics are recorded for the last period only
+        LockRegistry::Snapshot& last = m_lastLocks[it->first];
+        unsigned long long acquisitions = it->second.acquisitions - last.acquisitions;
+        // Waits are counted when they begin but measured when they end, possibly in a later period
+        if (acquisitions > 0 || it->second.wait.count() != last.wait.count() || it->second.hold.count() != last.hold.count()) {
+            Histogram wait = it->second.wait.since(last.wait);
+            Histogram hold = it->second.hold.since(last.hold);
+            double values[] = {double(acquisitions), double(it->second.contentions - last.contentions),
+                               wait.percentile(50.), wait.percentile(99.), wait.max(),
+                               hold.percentile(50.), hold.percentile(99.), hold.max()};
+            writeMetric(getTypeName(ProfilingType::LOCK), it->first, LOCK_FIELDS, values);
+        }
+        last = it->second;
+    }
+}
+
+void UProfileImpl::dumpFrames(bool rawFrameTimes)
+{
+    if (rawFrameTimes) {
+        // Raw frames are timestamped when collected from the time elapsed since their mark
+        std::map<std::string, std::vector<FrameTracker::RawFrame>> frames = FrameTracker::instance().collectRawFrames();
+        unsigned long long now = FrameTracker::now();
+        unsigned long long timestamp = getTimestamp();
+        for (auto it = frames.cbegin(); it != frames.cend(); ++it) {
+            for (auto frame = it->second.cbegin(); frame != it->second.cend(); ++frame) {
+                write(ProfilingType::FRAME_TIME, timestamp - (now - frame->time) / 1000000, {it->first, formatValue(frame->frameTime)});
+            }
+        }
+    }
+
+    std::map<std::string, FrameTracker::Snapshot> channels = FrameTracker::instance().collect();
+    for (auto it = channels.cbegin(); it != channels.cend(); ++it) {
+        // Statistics are recorded for the last period only
+        FrameTracker::Snapshot& last = m_lastFrames[it->first];
+        const FrameTracker::Snapshot& current = it->second;
+        unsigned long long frames = current.frames - last.frames;
+        if (frames > 0) {
+            Histogram frameTimes = current.frameTimes.since(last.frameTimes);
+            double average = (current.sum - last.sum) / frames;
+            double variance = (current.sumSquares - last.sumSquares) / frames - average * average;
+            // The rate of the first period is computed from the frame times only
+            double elapsed = last.time > 0 ? (current.time - last.time) / 1000000. : current.sum - last.sum;
+            double values[] = {elapsed > 0. ? frames * 1000. / elapsed : 0., double(frames), average,
+                               frameTimes.percentile(50.), frameTimes.percentile(99.), frameTimes.max(),
+                               variance > 0. ? std::sqrt(variance) : 0., double(current.missed - last.missed)};
+            writeMetric(getTypeName(ProfilingType::FRAME), it->first, FRAME_FIELDS, values);
+        }
+        last = current;
+    }
+}
+
+void UProfileImpl::dumpSelf()
+{
+    // Monitors run on the scheduler thread, which is the current one
+    EventWriter::Counters counters = m_writer.counters();
+    std::vector<unsigned long long> current = {SelfStats::threadCpuTime() + m_writer.threadCpuTime(),
+                                               m_selfStats.get(SelfStats::API_TIME),
+                                               m_selfStats.get(SelfStats::WRITE_TIME),
+                                               counters.events,
+                                               counters.bytes,
+                                               m_selfStats.get(SelfStats::LOCK_WAIT),
+                                               counters.dropped,
+                                               m_selfStats.get(SelfStats::FILTERED)};
+    if (m_lastSelf.size() != current.size()) {
+        m_lastSelf.assign(current.size(), 0);
+    }
+
+    // Values are written for the last period only (times in ms and us)
+    static const double scales[] = {1000000., 1000., 1000., 1., 1., 1000., 1., 1.};
+    double values[8];
+    for (size_t i = 0; i < current.size(); ++i) {
+        // A value lower than the previous one was reset (restarted thread, new file)
+        unsigned long long delta = current[i] >= m_lastSelf[i] ? current[i] - m_lastSelf[i] : current[i];
+        values[i] = delta / scales[i];
+    }
+    m_lastSelf = current;
+    writeMetric(getTypeName(ProfilingType::SELF), "", SELF_FIELDS, values);
+}
+
+void UProfileImpl::dumpThreadUsage()
+{
+    unsigned long long timestamp = getTimestamp();
+    const std::vector<const ThreadMonitor::ThreadUsage*>& threads = m_threadMonitor->sample(m_threadTopN);
+    for (auto it = threads.cbegin(); it != threads.cend(); ++it) {
+        const ThreadMonitor::ThreadUsage& thread = **it;
+        write(ProfilingType::THREAD, timestamp,
+              {std::to_string(thread.tid), thread.name, formatValue(thread.usage), std::to_string(thread.cpu), std::string(1, thread.state)});
+    }
+}
+
+void UProfileImpl::dumpProcessesUsage()
+{
+    unsigned long long timestamp = getTimestamp();
+    const std::vector<const ProcessMonitor::ProcessUsage*>& processes = m_processMonitor->sample();
+    for (auto it = processes.cbegin(); it != processes.cend(); ++it) {
+        const ProcessMonitor::ProcessUsage& process = **it;
+        write(ProfilingType::PROCESS, timestamp,
+              {std::to_string(process.pid), process.name, formatValue(process.usage), std::to_string(process.rss),
+               std::to_string(process.pss), std::to_string(process.threads)});
     }
 }
 
 vector<float> UProfileImpl::getInstantCpuUsage()
 {
     // To get instaneous CPU usage, we should wait at least one unit between two polling (aka: 100 ms)
-    m_cpuMonitor.getUsage();
+    CpuMonitor cpuMonitor;
+    cpuMonitor.getUsage();
     this_thread::sleep_for(std::chrono::milliseconds(100));
-    return m_cpuMonitor.getUsage();
+    return cpuMonitor.getUsage();
+}
+
+std::map<std::string, Scheduler::TaskStats> UProfileImpl::getTaskStats() const
+{
+    return m_scheduler.stats();
 }
 
 void UProfileImpl::stop()
 {
-    m_processMemoryMonitorTimer.stop();
-    m_systemMemoryMonitorTimer.stop();
-    m_cpuMonitorTimer.stop();
-    m_gpuUsageMonitorTimer.stop();
-    m_gpuMemoryMonitorTimer.stop();
-    if (m_gpuMonitor) {
-        m_gpuMonitor->stop();
+    if (m_started.exchange(false)) {
+        Activation::profilerStopped();
+    }
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+    FunctionInstrumentation::instance().stop(this);
+#endif
+    m_scheduler.clear();
+    m_adaptive.reset();
+    m_selfMonitoring = false;
+    m_writer.setSelfStats(nullptr);
+    std::unique_lock<std::mutex> lk(m_monitorsMutex);
+    m_monitors.clear();
+    lk.unlock();
+    std::unique_lock<std::mutex> gpuLock(m_gpuMonitorsMutex);
+    for (auto it = m_gpuMonitors.cbegin(); it != m_gpuMonitors.cend(); ++it) {
+        (*it)->stop();
+    }
+    gpuLock.unlock();
+    std::unique_lock<std::mutex> rollupsLock(m_rollupsMutex);
+    if (m_rollups) {
+        m_rollups->flush();
+    }
+    rollupsLock.unlock();
+    flushRetainedRecords();
+    m_writer.flush();
+    std::lock_guard<std::mutex> selfGuard(m_selfMutex);
+    if (m_fileSink) {
+        m_writer.removeSink(m_fileSink);
+        m_fileSink = nullptr;
     }
-    m_file.reset();
 }
 
 void UProfileImpl::setTimestampUnit(TimestampUnit tsUnit)
@@ -235,39 +759,314 @@ void UProfileImpl::setTimestampUnit(TimestampUnit tsUnit)
     m_tsUnit = tsUnit;
 }
 
+void UProfileImpl::enableRollups(bool keepRawSamples, int rawRetention)
+{
+    std::lock_guard<std::mutex> guard(m_rollupsMutex);
+    m_keepRawSamples = keepRawSamples;
+    m_rawRetention = rawRetention > 0 ? static_cast<unsigned long long>(rawRetention) * 60000 : 0;
+    m_rollups.reset(new RollupAggregator([=](const std::string& metric, const std::string& instance, const std::string& field,
+                                             unsigned long long resolution, const RollupAggregator::Bucket& bucket) {
+        writeRollup(metric, instance, field, resolution, bucket);
+    }));
+}
+
+void UProfileImpl::setDeadband(MonitorType monitor, double absThreshold, double relThreshold, int heartbeat)
+{
+    std::string metric = getTypeName(getProfilingType(monitor));
+    DeadbandFilter* filter = new DeadbandFilter(absThreshold, relThreshold, heartbeat > 0 ? heartbeat : 0);
+
+    std::lock_guard<std::mutex> guard(m_deadbandsMutex);
+    m_deadbands[metric].reset(filter);
+    writeDeadband(metric, *filter);
+}
+
+void UProfileImpl::enableFlightRecorder(const char* dumpPath, size_t capacity)
+{
+    if (!dumpPath || capacity == 0) {
+        std::cerr << "Invalid flight recorder parameters" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> guard(m_recorderMutex);
+    std::unique_ptr<FlightRecorder> recorder(new FlightRecorder(dumpPath, capacity));
+    m_writer.setRecorder(recorder.get());
+    m_recorder.swap(recorder);
+}
+
+bool UProfileImpl::dumpFlightRecorder()
+{
+    std::lock_guard<std::mutex> guard(m_recorderMutex);
+    if (!m_recorder) {
+        std::cerr << "Flight recorder is not enabled" << std::endl;
+        return false;
+    }
+    return m_recorder->dump();
+}
+
+void UProfileImpl::setFlightRecorderLatencyTrigger(unsigned long long threshold)
+{
+    m_dumpLatency = threshold;
+}
+
+void UProfileImpl::addAdaptiveRule(const AdaptiveRule& rule)
+{
+    if (rule.metric.empty() || rule.monitors.empty() || rule.fastPeriod <= 0 || rule.window <= 0) {
+        std::cerr << "Invalid adaptive rule: " << rule.name << std::endl;
+        return;
+    }
+    std::vector<std::string> monitors;
+    for (auto it = rule.monitors.cbegin(); it != rule.monitors.cend(); ++it) {
+        monitors.push_back(getTypeName(getProfilingType(*it)));
+    }
+    m_adaptive.addRule(rule, monitors);
+}
+
+void UProfileImpl::clearAdaptiveRules()
+{
+    m_adaptive.clear();
+}
+
+void UProfileImpl::startFunctionInstrumentation(unsigned int minDuration)
+{
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+    FunctionInstrumentation::instance().start(this, static_cast<unsigned long long>(minDuration) * 1000);
+#else
+    (void)minDuration;
+    std::cerr << "Cannot instrument functions: library built without FUNCTION_INSTRUMENTATION_ENABLED!" << std::endl;
+#endif
+}
+
+void UProfileImpl::stopFunctionInstrumentation()
+{
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+    FunctionInstrumentation::instance().stop(this);
+#endif
+}
+
+void UProfileImpl::setFunctionFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes)
+{
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+    FunctionInstrumentation::instance().setFilters(includes, excludes);
+#else
+    (void)includes;
+    (void)excludes;
+#endif
+}
+
+void UProfileImpl::writeFunctionCall(const std::string& location, unsigned long long duration, int tid)
+{
+    if (!m_started) {
+        return;
+    }
+    unsigned long long timestamp = getTimestamp();
+    write(ProfilingType::FUNCTION, timestamp, {std::to_string(timestamp - duration / 1000000), location, std::to_string(duration / 1000), std::to_string(tid)});
+}
+
 void UProfileImpl::write(ProfilingType type, const std::list<std::string>& data)
 {
-    if (!m_file) {
+    write(type, getTimestamp(), data);
+}
+
+void UProfileImpl::write(ProfilingType type, unsigned long long timestamp, const std::list<std::string>& data)
+{
+    m_writer.write(getTypeName(type), timestamp, data);
+}
+
+void UProfileImpl::write(const std::string& event, unsigned long long timestamp, const std::list<std::string>& data)
+{
+    m_writer.write(event.c_str(), timestamp, data);
+}
+
+void UProfileImpl::writeMetric(const std::string& metric, const std::string& instance, const std::vector<std::string>& fields, const double* values)
+{
+    m_adaptive.onSample(metric, instance, fields, values);
+
+    unsigned long long timestamp = getTimestamp();
+    bool keepRawSamples = true;
+    unsigned long long rawRetention = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_rollupsMutex);
+        if (m_rollups) {
+            for (size_t i = 0; i < fields.size(); ++i) {
+                m_rollups->add(metric, instance, fields[i], values[i], timestamp);
+            }
+            keepRawSamples = m_keepRawSamples;
+            rawRetention = m_rawRetention;
+        }
+    }
+    if (!keepRawSamples) {
+        if (m_selfMonitoring.load(std::memory_order_relaxed)) {
+            m_selfStats.add(SelfStats::FILTERED, 1);
+        }
+        return;
+    }
+
+    if (!acceptSample(metric, instance, values, fields.size(), timestamp)) {
+        if (m_selfMonitoring.load(std::memory_order_relaxed)) {
+            m_selfStats.add(SelfStats::FILTERED, 1);
+        }
+        return;
+    }
+
+    // CPU and GPU usages keep the format of their records before the metric monitors (always with decimals)
+    const bool decimals = metric == getTypeName(ProfilingType::CPU) || metric == getTypeName(ProfilingType::GPU_USAGE);
+    std::list<std::string> data;
+    if (!instance.empty()) {
+        data.push_back(instance);
+    }
+    for (size_t i = 0; i < fields.size(); ++i) {
+        data.push_back(formatValue(values[i], decimals));
+    }
+
+    if (rawRetention > 0) {
+        // Only keep the most recent raw samples in memory, they are written when profiling stops
+        std::lock_guard<std::mutex> guard(m_retainedMutex);
+        m_retainedRecords.push_back({metric, timestamp, data});
+        while (!m_retainedRecords.empty() && m_retainedRecords.front().timestamp + rawRetention < timestamp) {
+            m_retainedRecords.pop_front();
+        }
         return;
     }
-    std::string strType;
+
+    write(metric, timestamp, data);
+}
+
+void UProfileImpl::writeRollup(const std::string& metric, const std::string& instance, const std::string& field,
+                               unsigned long long resolution, const RollupAggregator::Bucket& bucket)
+{
+    write(ProfilingType::ROLLUP, {metric, instance, field, std::to_string(resolution), std::to_string(bucket.start),
+                                  formatValue(bucket.min), formatValue(bucket.max), formatValue(bucket.sum / bucket.count), formatValue(bucket.last)});
+}
+
+void UProfileImpl::flushRetainedRecords()
+{
+    std::lock_guard<std::mutex> guard(m_retainedMutex);
+    for (auto it = m_retainedRecords.cbegin(); it != m_retainedRecords.cend(); ++it) {
+        write(it->event, it->timestamp, it->data);
+    }
+    m_retainedRecords.clear();
+}
+
+bool UProfileImpl::acceptSample(const std::string& metric, const std::string& instance, const double* values, size_t count, unsigned long long timestamp)
+{
+    std::lock_guard<std::mutex> guard(m_deadbandsMutex);
+    auto it = m_deadbands.find(metric);
+    return it == m_deadbands.end() || it->second->accept(instance, values, count, timestamp);
+}
+
+void UProfileImpl::writeDeadband(const std::string& metric, const DeadbandFilter& filter)
+{
+    write(ProfilingType::DEADBAND, {metric, formatValue(filter.absThreshold()), formatValue(filter.relThreshold()), std::to_string(filter.heartbeat())});
+}
+
+UProfileImpl::ProfilingType UProfileImpl::getProfilingType(MonitorType monitor)
+{
+    switch (monitor) {
+    case MonitorType::PROCESS_MEMORY:
+        return ProfilingType::PROCESS_MEMORY;
+    case MonitorType::SYSTEM_MEMORY:
+        return ProfilingType::SYSTEM_MEMORY;
+    case MonitorType::CPU:
+        return ProfilingType::CPU;
+    case MonitorType::GPU_USAGE:
+        return ProfilingType::GPU_USAGE;
+    case MonitorType::PROCESS_IO:
+        return ProfilingType::PROCESS_IO;
+    case MonitorType::DISK_IO:
+        return ProfilingType::DISK_IO;
+    case MonitorType::NETWORK_IO:
+        return ProfilingType::NETWORK_IO;
+    case MonitorType::CGROUP:
+        return ProfilingType::CGROUP;
+    case MonitorType::PRESSURE:
+        return ProfilingType::PRESSURE;
+    case MonitorType::CPU_FREQUENCY:
+        return ProfilingType::CPU_FREQUENCY;
+    case MonitorType::NUMA_MEMORY:
+        return ProfilingType::NUMA_MEMORY;
+    case MonitorType::PROCESS_NUMA:
+        return ProfilingType::PROCESS_NUMA;
+    case MonitorType::GPU_MEMORY:
+    default:
+        return ProfilingType::GPU_MEMORY;
+    }
+}
+
+const char* UProfileImpl::getTypeName(ProfilingType type)
+{
     switch (type) {
     case ProfilingType::TIME_EXEC:
-        strType = "time_exec";
-        break;
+        return "time_exec";
     case ProfilingType::TIME_EVENT:
-        strType = "time_event";
-        break;
+        return "time_event";
     case ProfilingType::PROCESS_MEMORY:
-        strType = "proc_mem";
-        break;
+        return "proc_mem";
     case ProfilingType::SYSTEM_MEMORY:
-        strType = "sys_mem";
-        break;
+        return "sys_mem";
     case ProfilingType::CPU:
-        strType = "cpu";
-        break;
+        return "cpu";
     case ProfilingType::GPU_USAGE:
-        strType = "gpu";
-        break;
+        return "gpu";
     case ProfilingType::GPU_MEMORY:
-        strType = "gpu_mem";
-        break;
+        return "gpu_mem";
+    case ProfilingType::PROCESS_IO:
+        return "proc_io";
+    case ProfilingType::DISK_IO:
+        return "disk_io";
+    case ProfilingType::NETWORK_IO:
+        return "net_io";
+    case ProfilingType::CGROUP:
+        return "cgroup";
+    case ProfilingType::PRESSURE:
+        return "psi";
+    case ProfilingType::CPU_FREQUENCY:
+        return "cpu_freq";
+    case ProfilingType::NUMA_MEMORY:
+        return "numa_mem";
+    case ProfilingType::PROCESS_NUMA:
+        return "proc_numa";
+    case ProfilingType::THREAD:
+        return "thread";
+    case ProfilingType::PROCESS:
+        return "process";
+    case ProfilingType::ROLLUP:
+        return "rollup";
+    case ProfilingType::DEADBAND:
+        return "deadband";
+    case ProfilingType::COUNTER:
+        return "counter";
+    case ProfilingType::GAUGE:
+        return "gauge";
+    case ProfilingType::HISTOGRAM:
+        return "histogram";
+    case ProfilingType::SCHEMA:
+        return "schema";
+    case ProfilingType::PERIOD:
+        return "period";
+    case ProfilingType::FUNCTION:
+        return "func";
+    case ProfilingType::LOCK:
+        return "lock";
+    case ProfilingType::FRAME:
+        return "frame";
+    case ProfilingType::FRAME_TIME:
+        return "frame_time";
+    case ProfilingType::SELF:
+        return "uprofile_self";
+    case ProfilingType::TOPOLOGY:
+        return "topology";
     default:
-        strType = "undefined";
-        break;
+        return "undefined";
+    }
+}
+
+std::string UProfileImpl::formatValue(double value, bool decimals)
+{
+    // Keep integer metrics (like memory) without decimals. Values a long long cannot hold
+    // (NaN, infinities, huge values from custom monitors) are not converted
+    if (!decimals && std::isfinite(value) && std::fabs(value) < 9e15 && value == static_cast<double>(static_cast<long long>(value))) {
+        return std::to_string(static_cast<long long>(value));
     }
-    m_file->write(strType, getTimestamp(), data);
+    return std::to_string(value);
 }
 
 unsigned long long UProfileImpl::getTimestamp() const
@@ -297,48 +1096,12 @@ unsigned long long UProfileImpl::getTimeSinceBoot()
 
 void UProfileImpl::getSystemMemory(int& totalMem, int& availableMem, int& freeMem)
 {
-
-#if defined(__linux__)
-    // /proc/meminfo returns the dump here:
-    // MemTotal: 515164 kB
-    // MemFree: 7348 kB
-    // MemAvailable: 7348 kB
-    ifstream meminfo("/proc/meminfo");
-    string line;
-    while (std::getline(meminfo, line)) {
-        if (line.find("MemTotal") != std::string::npos) {
-            stringstream ls(line);
-            ls.ignore(256, ' ');
-            ls >> totalMem;
-        } else if (line.find("MemFree") != std::string::npos) {
-            stringstream ls(line);
-            ls.ignore(256, ' ');
-            ls >> freeMem;
-        } else if (line.find("MemAvailable") != std::string::npos) {
-            {
-                stringstream ls(line);
-                ls.ignore(256, ' ');
-                ls >> availableMem;
-                break;
-            }
-        }
-    }
-#endif
+    SystemMemoryMonitor::read(totalMem, availableMem, freeMem);
 }
 
 void UProfileImpl::getProcessMemory(int& rss, int& shared)
 {
-
-#if defined(__linux__)
-    int tSize = 0, resident = 0, share = 0;
-    ifstream buffer("/proc/self/statm");
-    buffer >> tSize >> resident >> share;
-    buffer.close();
-
-    long page_size_kb = getpagesize() / 1024;
-    rss = resident * page_size_kb;
-    shared = share * page_size_kb;
-#endif
+    ProcessMemoryMonitor::read(rss, shared);
 }
 
 }
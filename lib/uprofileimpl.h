@@ -10,19 +10,39 @@
 #ifndef UPROFILEIMPL_H_
 #define UPROFILEIMPL_H_
 
-#include "eventsfile.h"
+#include "adaptiverule.h"
+#include "eventwriter.h"
+#include "frametracker.h"
+#include "ieventsink.h"
 #include "igpumonitor.h"
+#include "imetricmonitor.h"
+#include "lockregistry.h"
+#include "monitortype.h"
 #include "timestampunit.h"
+#include "util/adaptivesampler.h"
 #include "util/cpumonitor.h"
-#include "util/timer.h"
+#include "util/deadband.h"
+#include "util/flightrecorder.h"
+#include "util/histogram.h"
+#include "util/rollup.h"
+#include "util/processmonitor.h"
+#include "util/scheduler.h"
+#include "util/selfstats.h"
+#include "util/threadmonitor.h"
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace uprofile
 {
+class FileSink;
+
 class UProfileImpl
 {
 public:
@@ -33,11 +53,37 @@ public:
         SYSTEM_MEMORY,
         CPU,
         GPU_USAGE,
-        GPU_MEMORY
+        GPU_MEMORY,
+        PROCESS_IO,
+        DISK_IO,
+        NETWORK_IO,
+        CGROUP,
+        PRESSURE,
+        CPU_FREQUENCY,
+        NUMA_MEMORY,
+        PROCESS_NUMA,
+        THREAD,
+        PROCESS,
+        ROLLUP,
+        DEADBAND,
+        COUNTER,
+        GAUGE,
+        HISTOGRAM,
+        SCHEMA,
+        PERIOD,
+        FUNCTION,
+        LOCK,
+        FRAME,
+        FRAME_TIME,
+        SELF,
+        TOPOLOGY
     };
 
+    // Default instance used by the uprofile free functions
     static UProfileImpl* getInstance();
     static void destroyInstance();
+
+    UProfileImpl();
     virtual ~UProfileImpl();
 
     // Implementation
@@ -45,46 +91,142 @@ public:
     void stop();
     void addGPUMonitor(IGPUMonitor* monitor);
     void removeGPUMonitor();
+    void addMonitor(IMetricMonitor* monitor, int period);
+    void removeMonitor(IMetricMonitor* monitor);
+    void addSink(IEventSink* sink, const std::vector<std::string>& events);
+    void removeSink(IEventSink* sink);
     void setTimestampUnit(TimestampUnit tsUnit);
+    void enableRollups(bool keepRawSamples, int rawRetention);
+    void setDeadband(MonitorType monitor, double absThreshold, double relThreshold, int heartbeat);
+    void enableFlightRecorder(const char* dumpPath, size_t capacity);
+    bool dumpFlightRecorder();
+    void setFlightRecorderLatencyTrigger(unsigned long long threshold);
+    void addAdaptiveRule(const AdaptiveRule& rule);
+    void clearAdaptiveRules();
+    void startFunctionInstrumentation(unsigned int minDuration);
+    void stopFunctionInstrumentation();
+    void setFunctionFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes);
+    // Record a call of an instrumented function lasting 'duration' ns
+    void writeFunctionCall(const std::string& location, unsigned long long duration, int tid);
     void timeBegin(const std::string& title);
     void timeEnd(const std::string& title);
     void startProcessMemoryMonitoring(int period);
     void startSystemMemoryMonitoring(int period);
     void startCPUUsageMonitoring(int period);
+    void startCPUFrequencyMonitoring(int period);
+    void startNumaMonitoring(int period);
     void startGPUUsageMonitoring(int period);
     void startGPUMemoryMonitoring(int period);
+    void startCountersMonitoring(int period);
+    void startLockMonitoring(int period);
+    void startFrameMonitoring(int period, bool rawFrameTimes);
+    void startSelfMonitoring(int period);
+    void startProcessIOMonitoring(int period);
+    void startDiskIOMonitoring(int period);
+    void startNetworkIOMonitoring(int period);
+    void startAffinityCPUUsageMonitoring(int period);
+    void startCgroupMonitoring(int period);
+    void startPressureMonitoring(int period);
+    void startThreadCPUMonitoring(int period, int topN);
+    void startProcessesMonitoring(int period, const std::vector<int>& pids, bool descendants);
     void getProcessMemory(int& rss, int& shared);
     void getSystemMemory(int& totalMem, int& availableMem, int& freeMem);
     vector<float> getInstantCpuUsage();
+    // Run statistics of the periodic tasks (named after their event)
+    std::map<std::string, Scheduler::TaskStats> getTaskStats() const;
+    unsigned long long getTimestamp() const;
+    static unsigned long long getEpochTime();
+    static unsigned long long getTimeSinceBoot();
 
 private:
-    static UProfileImpl* m_uprofiler;
-    UProfileImpl();
+    static std::atomic<UProfileImpl*> m_uprofiler;
+    static std::mutex m_instanceMutex;
+
+    // Raw record kept in memory when raw samples retention is enabled
+    struct RetainedRecord {
+        std::string event;
+        unsigned long long timestamp;
+        std::list<std::string> data;
+    };
 
     void write(ProfilingType type, const std::list<std::string>& data);
-    unsigned long long getTimestamp() const;
-    static unsigned long long getEpochTime();
-    static unsigned long long getTimeSinceBoot();
+    void write(ProfilingType type, unsigned long long timestamp, const std::list<std::string>& data);
+    void write(const std::string& event, unsigned long long timestamp, const std::list<std::string>& data);
+    // Write a record of 'fields.size()' values
+    void writeMetric(const std::string& metric, const std::string& instance, const std::vector<std::string>& fields, const double* values);
+    void writeRollup(const std::string& metric, const std::string& instance, const std::string& field,
+                     unsigned long long resolution, const RollupAggregator::Bucket& bucket);
+    void flushRetainedRecords();
+    bool acceptSample(const std::string& metric, const std::string& instance, const double* values, size_t count, unsigned long long timestamp);
+    void writeDeadband(const std::string& metric, const DeadbandFilter& filter);
+    static ProfilingType getProfilingType(MonitorType monitor);
+    static const char* getTypeName(ProfilingType type);
+    static std::string formatValue(double value, bool decimals = false);
 
-    void dumpCpuUsage();
-    void dumpProcessMemory();
-    void dumpSystemMemory();
+    // Monitor sampled by the scheduler into a preallocated buffer
+    struct MonitorEntry {
+        std::unique_ptr<IMetricMonitor> monitor;
+        MetricSchema schema;
+        std::vector<double> values;
+        bool custom; // added through addMonitor()
+    };
+
+    void startMonitor(IMetricMonitor* monitor, int period, bool custom);
+    void sampleMonitor(MonitorEntry& entry);
+    void writeSchema(const MetricSchema& schema);
+    // Write the CPU topology at the start of each capture once a topology monitor is started
+    void recordTopology();
+    void writeTopology();
+
+    bool startGPUMonitors(int period); // false if no GPU monitor is set
+    static std::string getGpuName(const std::vector<std::string>& names, size_t index, size_t number);
     void dumpGpuUsage();
     void dumpGpuMemory();
+    void dumpCounters();
+    void dumpLocks();
+    void dumpFrames(bool rawFrameTimes);
+    void dumpSelf();
+    void dumpThreadUsage();
+    void dumpProcessesUsage();
 
     TimestampUnit m_tsUnit;
+    std::atomic<bool> m_started;
     std::map<std::string, unsigned long long> m_steps; // Store steps (title, start time)
-    EventsFilePtr m_file = nullptr;
-    Timer m_processMemoryMonitorTimer;
-    Timer m_systemMemoryMonitorTimer;
-    Timer m_cpuMonitorTimer;
-    Timer m_gpuUsageMonitorTimer;
-    Timer m_gpuMemoryMonitorTimer;
-    CpuMonitor m_cpuMonitor;
-    IGPUMonitor* m_gpuMonitor;
-
-    std::mutex m_fileMutex;
+    EventWriter m_writer;
+    FileSink* m_fileSink = nullptr; // sink of the file passed to start()
+    std::unique_ptr<FlightRecorder> m_recorder;
+    std::atomic<unsigned long long> m_dumpLatency;       // span duration triggering a dump (ms), 0 to disable
+    std::atomic<unsigned long long> m_lastTriggeredDump; // ms
+    Scheduler m_scheduler; // single thread sampling all the monitors
+    AdaptiveSampler m_adaptive;
+    std::map<std::string, std::unique_ptr<MonitorEntry>> m_monitors;
+    std::unique_ptr<ThreadMonitor> m_threadMonitor;
+    std::atomic<int> m_threadTopN;
+    std::unique_ptr<ProcessMonitor> m_processMonitor;
+    std::vector<std::unique_ptr<IGPUMonitor>> m_gpuMonitors;
+    std::unique_ptr<RollupAggregator> m_rollups;
+    bool m_keepRawSamples = true;
+    unsigned long long m_rawRetention = 0; // ms
+    std::deque<RetainedRecord> m_retainedRecords;
+    std::map<std::string, std::unique_ptr<DeadbandFilter>> m_deadbands; // Change detection per metric
+    std::map<std::string, long long> m_lastCounters;                   // Counters at the previous dump
+    std::map<std::string, Histogram> m_lastHistograms;                 // Histograms at the previous dump
+    std::map<std::string, LockRegistry::Snapshot> m_lastLocks;         // Lock statistics at the previous dump
+    std::map<std::string, FrameTracker::Snapshot> m_lastFrames;        // Frame statistics at the previous dump
+    SelfStats m_selfStats;
+    std::atomic<bool> m_selfMonitoring;
+    std::vector<unsigned long long> m_lastSelf; // Overhead values at the previous dump
+    std::mutex m_selfMutex;                     // protects the file sink
+    std::atomic<bool> m_recordTopology;
+    std::atomic<bool> m_topologyWritten; // in the current capture
+
+    std::mutex m_monitorsMutex;
+    std::mutex m_gpuMonitorsMutex;
     std::mutex m_stepsMutex;
+    std::mutex m_retainedMutex;
+    std::mutex m_rollupsMutex; // protects the rollups and their settings
+    std::mutex m_deadbandsMutex;
+    std::mutex m_recorderMutex;
 };
 
 }
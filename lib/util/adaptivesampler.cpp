@@ -0,0 +1,151 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "adaptivesampler.h"
+
+#include <algorithm>
+
+namespace uprofile
+{
+
+static const std::string SPAN_METRIC = "time_exec";
+
+AdaptiveSampler::AdaptiveSampler(Scheduler& scheduler, const Callback& callback) :
+    m_scheduler(scheduler),
+    m_callback(callback),
+    m_empty(true)
+{
+}
+
+void AdaptiveSampler::addRule(const AdaptiveRule& rule, const std::vector<std::string>& monitors)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    Rule entry;
+    entry.rule = rule;
+    entry.monitors = monitors;
+    m_rules.push_back(entry);
+    m_empty = false;
+}
+
+void AdaptiveSampler::clear()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_rules.clear();
+    m_empty = true;
+    backOff(Clock::time_point::max());
+}
+
+void AdaptiveSampler::reset()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_boosts.clear();
+    for (auto it = m_rules.begin(); it != m_rules.end(); ++it) {
+        it->previous.clear();
+    }
+}
+
+bool AdaptiveSampler::empty() const
+{
+    return m_empty;
+}
+
+void AdaptiveSampler::onSample(const std::string& metric, const std::string& instance, const std::vector<std::string>& fields, const double* values)
+{
+    if (m_empty) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_rules.begin(); it != m_rules.end(); ++it) {
+        Rule& rule = *it;
+        if (rule.rule.metric != metric) {
+            continue;
+        }
+        auto field = std::find(fields.begin(), fields.end(), rule.rule.field);
+        if (field == fields.end()) {
+            continue;
+        }
+        double value = values[field - fields.begin()];
+
+        bool triggered = false;
+        if (rule.rule.rate) {
+            auto previous = rule.previous.find(instance);
+            if (previous != rule.previous.end()) {
+                double elapsed = std::chrono::duration<double>(now - previous->second.second).count();
+                triggered = elapsed > 0. && (value - previous->second.first) / elapsed > rule.rule.threshold;
+            }
+            rule.previous[instance] = std::make_pair(value, now);
+        } else {
+            triggered = value > rule.rule.threshold;
+        }
+        if (triggered) {
+            trigger(rule, now);
+        }
+    }
+    backOff(now);
+}
+
+void AdaptiveSampler::onSpan(const std::string& title, unsigned long long duration)
+{
+    if (m_empty) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_rules.begin(); it != m_rules.end(); ++it) {
+        const AdaptiveRule& rule = it->rule;
+        if (rule.metric == SPAN_METRIC && (rule.field.empty() || rule.field == title) && duration >= rule.threshold) {
+            trigger(*it, now);
+        }
+    }
+    backOff(now);
+}
+
+void AdaptiveSampler::trigger(const Rule& rule, Clock::time_point now)
+{
+    Clock::time_point until = now + std::chrono::milliseconds(rule.rule.window);
+    for (auto it = rule.monitors.begin(); it != rule.monitors.end(); ++it) {
+        auto boost = m_boosts.find(*it);
+        if (boost == m_boosts.end()) {
+            int basePeriod = m_scheduler.period(*it);
+            if (basePeriod == 0 || basePeriod <= rule.rule.fastPeriod) {
+                // Monitor not started or already fast enough
+                continue;
+            }
+            m_boosts[*it] = {basePeriod, rule.rule.fastPeriod, until};
+        } else {
+            boost->second.until = std::max(boost->second.until, until);
+            if (rule.rule.fastPeriod >= boost->second.period) {
+                continue;
+            }
+            boost->second.period = rule.rule.fastPeriod;
+        }
+        if (m_scheduler.setPeriod(*it, rule.rule.fastPeriod)) {
+            m_callback(*it, rule.rule.fastPeriod, rule.rule.name);
+        }
+    }
+}
+
+void AdaptiveSampler::backOff(Clock::time_point now)
+{
+    for (auto it = m_boosts.begin(); it != m_boosts.end();) {
+        if (it->second.until > now) {
+            ++it;
+            continue;
+        }
+        if (m_scheduler.setPeriod(it->first, it->second.basePeriod)) {
+            m_callback(it->first, it->second.basePeriod, "");
+        }
+        it = m_boosts.erase(it);
+    }
+}
+
+}
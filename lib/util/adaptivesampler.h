@@ -0,0 +1,79 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef ADAPTIVESAMPLER_H_
+#define ADAPTIVESAMPLER_H_
+
+#include "adaptiverule.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Evaluate the adaptive rules on each sample and span, and switch the period
+ * of the scheduled monitors accordingly
+ *
+ * The callback is called each time the period of a monitor changes, with the
+ * name of the triggering rule (empty when going back to the base period).
+ */
+class AdaptiveSampler
+{
+public:
+    using Callback = std::function<void(const std::string& monitor, int period, const std::string& rule)>;
+
+    AdaptiveSampler(Scheduler& scheduler, const Callback& callback);
+
+    // Monitor names are the scheduler task names
+    void addRule(const AdaptiveRule& rule, const std::vector<std::string>& monitors);
+    // Remove all rules and restore the base periods
+    void clear();
+    // Forget the switched monitors (monitors have been stopped)
+    void reset();
+    bool empty() const;
+
+    void onSample(const std::string& metric, const std::string& instance, const std::vector<std::string>& fields, const double* values);
+    void onSpan(const std::string& title, unsigned long long duration);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Rule {
+        AdaptiveRule rule;
+        std::vector<std::string> monitors;
+        std::map<std::string, std::pair<double, Clock::time_point>> previous; // last value of each instance (rates)
+    };
+    struct Boost {
+        int basePeriod;
+        int period;
+        Clock::time_point until;
+    };
+
+    void trigger(const Rule& rule, Clock::time_point now);
+    void backOff(Clock::time_point now);
+
+    Scheduler& m_scheduler;
+    Callback m_callback;
+    std::vector<Rule> m_rules;
+    std::map<std::string, Boost> m_boosts; // switched monitors
+    std::atomic<bool> m_empty; // no rule: samples and spans are not evaluated
+    mutable std::mutex m_mutex;
+};
+
+}
+
+#endif /* ADAPTIVESAMPLER_H_ */
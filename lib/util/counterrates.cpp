@@ -0,0 +1,37 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "counterrates.h"
+
+namespace uprofile
+{
+
+CounterRates::CounterRates(size_t size) :
+    m_lastCounters(size, 0),
+    m_first(true)
+{
+}
+
+double CounterRates::update(const unsigned long long* counters, double* rates)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastTime).count();
+    for (size_t i = 0; i < m_lastCounters.size(); ++i) {
+        // A counter going backwards has been reset (e.g. device removed)
+        bool valid = !m_first && elapsed > 0. && counters[i] >= m_lastCounters[i];
+        rates[i] = valid ? (counters[i] - m_lastCounters[i]) / elapsed : 0.;
+        m_lastCounters[i] = counters[i];
+    }
+    m_lastTime = now;
+    bool first = m_first;
+    m_first = false;
+    return first ? 0. : elapsed;
+}
+
+}
@@ -0,0 +1,40 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef COUNTERRATES_H_
+#define COUNTERRATES_H_
+
+#include <chrono>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Conversion of cumulative counters (bytes, packets...) into
+ * per second rates between two consecutive samples
+ */
+class CounterRates
+{
+public:
+    explicit CounterRates(size_t size);
+
+    // Fill 'rates' with the rate of each counter since the previous call (0 for the first call)
+    // and return the elapsed time in seconds
+    double update(const unsigned long long* counters, double* rates);
+
+private:
+    std::vector<unsigned long long> m_lastCounters;
+    std::chrono::steady_clock::time_point m_lastTime;
+    bool m_first;
+};
+
+}
+
+#endif /* COUNTERRATES_H_ */
@@ -8,12 +8,17 @@
 // Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
 
 #include "cpumonitor.h"
+#include "cputopology.h"
+#include "systemroot.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 
 using namespace std;
 
 uprofile::CpuMonitor::CpuMonitor() :
+    m_procStat(SystemRoot::path("/proc/stat")),
     m_nbCpus(getNumberOfCPUCores()),
     m_lastIdleTimes(m_nbCpus, 0),
     m_lastTotalTimes(m_nbCpus, 0)
@@ -28,41 +33,39 @@ size_t uprofile::CpuMonitor::getNumberOfCPUCores()
 {
     size_t nbCores = 0;
 #if defined(__linux__)
-    ifstream meminfo("/proc/cpuinfo");
+    // Present CPUs, offline ones included
+    std::vector<int> present = CpuTopology::presentCpus();
+    if (!present.empty()) {
+        return *std::max_element(present.begin(), present.end()) + 1;
+    }
+
+    // Without sysfs, only the online CPUs are listed in /proc/cpuinfo
+    ifstream cpuinfo(SystemRoot::path("/proc/cpuinfo"));
     string str;
-    while (getline(meminfo, str)) {
+    while (getline(cpuinfo, str)) {
         if (str.rfind("processor", 0) == 0) {
-            nbCores++;
+            size_t colon = str.find(':');
+            size_t index = colon != string::npos ? strtoul(str.c_str() + colon + 1, nullptr, 10) : nbCores;
+            nbCores = std::max(nbCores, index + 1);
         }
     }
 #endif
     return nbCores;
 }
 
-void uprofile::CpuMonitor::extractCpuTimes(const string& cpuInfo, size_t& idleTime, size_t& totalTime)
+vector<float> uprofile::CpuMonitor::getUsage()
 {
-    // Remove 'cpu<index' word and
-    // extract the idle time and sum all other times
-    size_t spacePos = cpuInfo.find(' ');
-    if (spacePos == string::npos) {
-        return;
-    }
-
-    stringstream times(cpuInfo.substr(spacePos + 1));
-    int index = 0;
-    for (size_t time; times >> time; ++index) {
-        if (index == 3) { // idle time i s the 4th param
-            idleTime = time;
-        }
-        totalTime += time;
-    }
+    vector<float> usages(m_nbCpus, 0);
+    getUsage(usages);
+    return usages;
 }
 
-vector<float> uprofile::CpuMonitor::getUsage()
+void uprofile::CpuMonitor::getUsage(vector<float>& usages)
 {
-    vector<float> usages(m_nbCpus, 0);
-#if defined(__linux__)
-    ifstream procStat("/proc/stat");
+    for (size_t cpuIndex = 0; cpuIndex < m_nbCpus; ++cpuIndex) {
+        usages[cpuIndex] = 0;
+    }
+
     // /proc/stat dumps the following info:
     //      user nice system idle iowait irq softirq
     // cpu  2255 34 2290 22625563 6290 127 456
@@ -70,31 +73,37 @@ vector<float> uprofile::CpuMonitor::getUsage()
     // cpu1 1123 0 849 11313845 2614 0 18
     // ...
     // Each numbers represents the amount of time the CPU has spent performing
-    // different kind of work
-
-    for (size_t cpuIndex = 0; cpuIndex < m_nbCpus; ++cpuIndex) {
-        string cpuName("cpu");
-        cpuName += to_string(cpuIndex);
-
-        // Look in /proc/stack the CPU info
-        string line;
-        while (getline(procStat, line)) {
-            if (line.find(cpuName) != std::string::npos) {
-                size_t idleTime = 0, totalTime = 0;
-                extractCpuTimes(line, idleTime, totalTime);
+    // different kind of work. Offline CPUs are not listed.
+    const char* pos = m_procStat.read();
+    while (pos && *pos != '\0') {
+        // Only the per CPU lines, whose index is parsed so that 'cpu1' never matches 'cpu10'
+        if (strncmp(pos, "cpu", 3) == 0 && pos[3] >= '0' && pos[3] <= '9') {
+            unsigned long long cpuIndex = 0;
+            pos = ProcFile::parseNumber(pos + 3, cpuIndex);
+            unsigned long long idleTime = 0, totalTime = 0;
+            for (int index = 0; *(pos = ProcFile::skipSpaces(pos)) >= '0' && *pos <= '9'; ++index) {
+                unsigned long long time = 0;
+                pos = ProcFile::parseNumber(pos, time);
+                if (index == 3) { // idle time is the 4th param
+                    idleTime = time;
+                }
+                totalTime += time;
+            }
 
+            if (cpuIndex < m_nbCpus) {
                 // To compute CPU load, we compute the time the CPU has been idle since the last read.
-                float cpuLoad = 100.0 * (1.0 - (float)(idleTime - m_lastIdleTimes[cpuIndex]) / (totalTime - m_lastTotalTimes[cpuIndex]));
-                usages[cpuIndex] = cpuLoad;
+                // Times are kept while the CPU is offline and resume from them when it is back.
+                unsigned long long total = totalTime - m_lastTotalTimes[cpuIndex];
+                unsigned long long idle = idleTime - m_lastIdleTimes[cpuIndex];
+                if (totalTime > m_lastTotalTimes[cpuIndex] && idleTime >= m_lastIdleTimes[cpuIndex] && idle <= total) {
+                    usages[cpuIndex] = 100.0 * (1.0 - (float)idle / total);
+                }
 
                 // Save the times value for the next read
                 m_lastIdleTimes[cpuIndex] = idleTime;
                 m_lastTotalTimes[cpuIndex] = totalTime;
-                break;
             }
         }
+        pos = ProcFile::nextLine(pos);
     }
-#endif
-
-    return usages;
 }
@@ -10,6 +10,7 @@
 #ifndef CPUMONITOR_H_
 #define CPUMONITOR_H_
 
+#include "procfile.h"
 #include <string>
 #include <vector>
 
@@ -18,6 +19,13 @@ using namespace std;
 namespace uprofile
 {
 
+/**
+ * Usage of each CPU computed from /proc/stat
+ *
+ * CPUs are identified by their index: the monitored CPUs are the ones present
+ * when the monitor is created, those offline (hotplug) report a null usage
+ * until they are back online.
+ */
 class CpuMonitor
 {
 public:
@@ -25,15 +33,18 @@ public:
     virtual ~CpuMonitor();
 
     vector<float> getUsage();
+    // Same as above without allocating (usages must hold getNumberOfCpus() values)
+    void getUsage(vector<float>& usages);
+    size_t getNumberOfCpus() const { return m_nbCpus; }
 
 private:
     static size_t getNumberOfCPUCores();
-    static void extractCpuTimes(const string& cpuInfo, size_t& idleTime, size_t& totalTime);
 
+    ProcFile m_procStat;
     size_t m_nbCpus;
     // Store the last idle and total time for each CPU
-    vector<size_t> m_lastIdleTimes;
-    vector<size_t> m_lastTotalTimes;
+    vector<unsigned long long> m_lastIdleTimes;
+    vector<unsigned long long> m_lastTotalTimes;
 };
 }
 
@@ -0,0 +1,106 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "cputopology.h"
+#include "procfile.h"
+#include "systemroot.h"
+
+#include <cstdlib>
+#include <map>
+
+namespace uprofile
+{
+
+static const char CPU_DIR[] = "/sys/devices/system/cpu";
+static const char NODE_DIR[] = "/sys/devices/system/node";
+
+// Return the first line of a sysfs file, empty if it cannot be read
+static std::string readLine(const std::string& path)
+{
+    ProcFile file(SystemRoot::path(path));
+    const char* content = file.read();
+    if (!content) {
+        return "";
+    }
+    std::string line(content);
+    size_t end = line.find('\n');
+    return end != std::string::npos ? line.substr(0, end) : line;
+}
+
+static int readNumber(const std::string& path)
+{
+    std::string line = readLine(path);
+    return line.empty() ? -1 : atoi(line.c_str());
+}
+
+std::vector<int> CpuTopology::parseList(const char* list)
+{
+    std::vector<int> items;
+    const char* pos = list;
+    while (pos && *(pos = ProcFile::skipSpaces(pos)) >= '0' && *pos <= '9') {
+        unsigned long long first = 0, last = 0;
+        pos = ProcFile::parseNumber(pos, first);
+        last = first;
+        if (*pos == '-') {
+            pos = ProcFile::parseNumber(pos + 1, last);
+        }
+        for (unsigned long long item = first; item <= last; ++item) {
+            items.push_back(static_cast<int>(item));
+        }
+        if (*pos == ',') {
+            ++pos;
+        }
+    }
+    return items;
+}
+
+std::vector<int> CpuTopology::presentCpus()
+{
+    return parseList(readLine(std::string(CPU_DIR) + "/present").c_str());
+}
+
+std::vector<int> CpuTopology::nodes()
+{
+    return parseList(readLine(std::string(NODE_DIR) + "/online").c_str());
+}
+
+std::vector<CpuTopology::Cpu> CpuTopology::read()
+{
+    std::vector<Cpu> cpus;
+    std::vector<int> present = presentCpus();
+    for (size_t i = 0; i < present.size(); ++i) {
+        std::string dir = std::string(CPU_DIR) + "/cpu" + std::to_string(present[i]) + "/topology";
+        Cpu cpu;
+        cpu.index = present[i];
+        cpu.package = readNumber(dir + "/physical_package_id");
+        cpu.core = readNumber(dir + "/core_id");
+        cpu.node = -1;
+        cpu.siblings = readLine(dir + "/thread_siblings_list");
+        cpus.push_back(cpu);
+    }
+
+    // The CPUs of each node are listed by the node
+    std::map<int, Cpu*> cpusByIndex;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        cpusByIndex[cpus[i].index] = &cpus[i];
+    }
+    std::vector<int> nodeIds = nodes();
+    for (size_t i = 0; i < nodeIds.size(); ++i) {
+        std::vector<int> nodeCpus = parseList(readLine(std::string(NODE_DIR) + "/node" + std::to_string(nodeIds[i]) + "/cpulist").c_str());
+        for (size_t j = 0; j < nodeCpus.size(); ++j) {
+            auto it = cpusByIndex.find(nodeCpus[j]);
+            if (it != cpusByIndex.end()) {
+                it->second->node = nodeIds[i];
+            }
+        }
+    }
+    return cpus;
+}
+
+}
@@ -0,0 +1,45 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef CPUTOPOLOGY_H_
+#define CPUTOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * CPU and NUMA topology read from sysfs (/sys/devices/system)
+ */
+class CpuTopology
+{
+public:
+    struct Cpu {
+        int index;
+        int package;          // physical package (socket), -1 if unknown
+        int core;             // core within the package, -1 if unknown
+        int node;             // NUMA node, -1 if unknown
+        std::string siblings; // SMT siblings list (e.g. "0,64"), empty if unknown
+    };
+
+    // Parse a sysfs CPU or node list (e.g. "0-3,8-11")
+    static std::vector<int> parseList(const char* list);
+    // CPUs present in the system, offline ones included
+    static std::vector<int> presentCpus();
+    // Online NUMA nodes, empty without NUMA support
+    static std::vector<int> nodes();
+    // Topology of the present CPUs
+    static std::vector<Cpu> read();
+};
+
+}
+
+#endif /* CPUTOPOLOGY_H_ */
@@ -0,0 +1,55 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "deadband.h"
+
+#include <cmath>
+
+namespace uprofile
+{
+
+DeadbandFilter::DeadbandFilter(double absThreshold, double relThreshold, unsigned long long heartbeat) :
+    m_absThreshold(absThreshold),
+    m_relThreshold(relThreshold),
+    m_heartbeat(heartbeat)
+{
+}
+
+bool DeadbandFilter::hasMoved(double last, double value) const
+{
+    double delta = std::fabs(value - last);
+    if (m_absThreshold <= 0. && m_relThreshold <= 0.) {
+        // No threshold: any change is recorded
+        return delta > 0.;
+    }
+    return (m_absThreshold > 0. && delta > m_absThreshold) ||
+           (m_relThreshold > 0. && delta > m_relThreshold * std::fabs(last));
+}
+
+bool DeadbandFilter::accept(const std::string& instance, const double* values, size_t count, unsigned long long timestamp)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_lastSamples.find(instance);
+    bool changed = it == m_lastSamples.end() || it->second.values.size() != count;
+    if (!changed && m_heartbeat > 0 && timestamp >= it->second.timestamp + m_heartbeat) {
+        changed = true;
+    }
+    for (size_t i = 0; !changed && i < count; ++i) {
+        changed = hasMoved(it->second.values[i], values[i]);
+    }
+
+    if (changed) {
+        LastSample& last = m_lastSamples[instance];
+        last.values.assign(values, values + count);
+        last.timestamp = timestamp;
+    }
+    return changed;
+}
+
+}
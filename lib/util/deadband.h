@@ -0,0 +1,56 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef DEADBAND_H_
+#define DEADBAND_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Change detection of periodic samples
+ *
+ * A sample is accepted when one of its values moved by more than the absolute
+ * or the relative threshold since the last accepted sample of the same instance,
+ * or when no sample has been accepted for the heartbeat duration.
+ */
+class DeadbandFilter
+{
+public:
+    DeadbandFilter(double absThreshold, double relThreshold, unsigned long long heartbeat /* ms */);
+
+    bool accept(const std::string& instance, const double* values, size_t count, unsigned long long timestamp);
+
+    double absThreshold() const { return m_absThreshold; }
+    double relThreshold() const { return m_relThreshold; }
+    unsigned long long heartbeat() const { return m_heartbeat; }
+
+private:
+    struct LastSample {
+        std::vector<double> values;
+        unsigned long long timestamp = 0;
+    };
+
+    bool hasMoved(double last, double value) const;
+
+    double m_absThreshold;
+    double m_relThreshold;
+    unsigned long long m_heartbeat;
+    std::mutex m_mutex;
+    std::map<std::string, LastSample> m_lastSamples;
+};
+
+}
+
+#endif /* DEADBAND_H_ */
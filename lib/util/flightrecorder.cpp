@@ -0,0 +1,197 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "flightrecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+const int FlightRecorder::MAX_RECORDERS;
+
+// Only lock-free atomics: recorders are read from signal handlers
+static std::atomic<FlightRecorder*> g_recorders[FlightRecorder::MAX_RECORDERS];
+static std::atomic_flag g_crashDumped = ATOMIC_FLAG_INIT;
+
+FlightRecorder::FlightRecorder(const std::string& dumpPath, size_t capacity) :
+    m_buffer(capacity > 0 ? capacity : 1),
+    m_head(0),
+    m_dumpIndex(0)
+{
+    size_t found = dumpPath.find_last_of('.');
+    size_t separator = dumpPath.find_last_of('/');
+    bool hasExtension = found != std::string::npos && (separator == std::string::npos || found > separator);
+    m_basePath = hasExtension ? dumpPath.substr(0, found) : dumpPath;
+    m_extension = hasExtension ? dumpPath.substr(found) : "";
+
+    for (int i = 0; i < MAX_RECORDERS; ++i) {
+        FlightRecorder* expected = nullptr;
+        if (g_recorders[i].compare_exchange_strong(expected, this)) {
+            return;
+        }
+    }
+    std::cerr << "Too many flight recorders: it will not be dumped on signals" << std::endl;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    for (int i = 0; i < MAX_RECORDERS; ++i) {
+        FlightRecorder* expected = this;
+        g_recorders[i].compare_exchange_strong(expected, nullptr);
+    }
+}
+
+void FlightRecorder::append(const char* record, size_t size)
+{
+    const size_t capacity = m_buffer.size();
+    if (size > capacity) {
+        return;
+    }
+    unsigned long long head = m_head.load(std::memory_order_relaxed);
+    size_t position = static_cast<size_t>(head % capacity);
+    size_t first = std::min(size, capacity - position);
+    memcpy(&m_buffer[position], record, first);
+    memcpy(&m_buffer[0], record + first, size - first);
+    m_head.store(head + size, std::memory_order_release);
+}
+
+bool FlightRecorder::dump()
+{
+#if defined(__linux__)
+    // Build '<base>_<index><extension>' without allocating
+    char path[PATH_MAX];
+    char digits[16];
+    unsigned int index = m_dumpIndex.fetch_add(1);
+    int nbDigits = 0;
+    do {
+        digits[nbDigits++] = static_cast<char>('0' + index % 10);
+        index /= 10;
+    } while (index > 0);
+    if (m_basePath.size() + nbDigits + m_extension.size() + 2 > sizeof(path)) {
+        return false;
+    }
+    char* end = path;
+    memcpy(end, m_basePath.c_str(), m_basePath.size());
+    end += m_basePath.size();
+    *end++ = '_';
+    while (nbDigits > 0) {
+        *end++ = digits[--nbDigits];
+    }
+    memcpy(end, m_extension.c_str(), m_extension.size());
+    end[m_extension.size()] = '\0';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+
+    const size_t capacity = m_buffer.size();
+    unsigned long long head = m_head.load(std::memory_order_acquire);
+    unsigned long long begin = head > capacity ? head - capacity : 0;
+    const char* data = &m_buffer[0];
+    if (begin > 0) {
+        // The ring has wrapped: skip the oldest partially overwritten record
+        while (begin < head && data[begin % capacity] != '\n') {
+            ++begin;
+        }
+        ++begin;
+    }
+
+    bool success = true;
+    while (begin < head && success) {
+        size_t position = static_cast<size_t>(begin % capacity);
+        size_t length = static_cast<size_t>(std::min<unsigned long long>(head - begin, capacity - position));
+        ssize_t written = write(fd, data + position, length);
+        success = written > 0;
+        begin += success ? written : 0;
+    }
+    close(fd);
+    return success;
+#else
+    return false;
+#endif
+}
+
+void FlightRecorder::dumpAll()
+{
+    for (int i = 0; i < MAX_RECORDERS; ++i) {
+        FlightRecorder* recorder = g_recorders[i].load();
+        if (recorder) {
+            recorder->dump();
+        }
+    }
+}
+
+void FlightRecorder::onDumpSignal(int /*signum*/)
+{
+    dumpAll();
+}
+
+void FlightRecorder::onFatalSignal(int signum)
+{
+#if defined(__linux__)
+    if (!g_crashDumped.test_and_set()) {
+        dumpAll();
+    }
+    // Let the default action (core dump, termination) happen
+    signal(signum, SIG_DFL);
+    raise(signum);
+#else
+    (void)signum;
+#endif
+}
+
+void FlightRecorder::enableSignalDump(int signum)
+{
+#if defined(__linux__)
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &FlightRecorder::onDumpSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, NULL) == -1) {
+        std::cerr << "Failed to install the flight recorder dump signal handler" << std::endl;
+    }
+#else
+    (void)signum;
+    std::cerr << "Flight recorder dump signal is not supported on this platform" << std::endl;
+#endif
+}
+
+void FlightRecorder::enableCrashDump()
+{
+#if defined(__linux__)
+    const int signals[] = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &FlightRecorder::onFatalSignal;
+    // Run on the alternate stack if the application set one up (stack overflow)
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+        if (sigaction(signals[i], &action, NULL) == -1) {
+            std::cerr << "Failed to install the flight recorder crash handler" << std::endl;
+        }
+    }
+#else
+    std::cerr << "Flight recorder crash dump is not supported on this platform" << std::endl;
+#endif
+}
+
+}
@@ -0,0 +1,64 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef FLIGHTRECORDER_H_
+#define FLIGHTRECORDER_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Fixed size memory ring of the most recent records, dumped to a file on demand
+ *
+ * Records are appended by the event writer (callers are serialized) without any
+ * disk I/O. Each dump creates a new file ('<path>_<index><extension>') holding the
+ * whole records of the ring, oldest first.
+ *
+ * dump() only uses async-signal-safe calls so that the ring can be saved from a
+ * signal handler, including fatal signal handlers. Records appended while dumping
+ * may overwrite the oldest records of the dump.
+ */
+class FlightRecorder
+{
+public:
+    FlightRecorder(const std::string& dumpPath, size_t capacity /* bytes */);
+    ~FlightRecorder();
+
+    void append(const char* record, size_t size);
+    bool dump();
+
+    // Dump all the flight recorders of the process when the signal is received
+    static void enableSignalDump(int signum);
+    // Dump all the flight recorders of the process on SIGSEGV, SIGABRT, SIGBUS, SIGFPE and SIGILL
+    static void enableCrashDump();
+
+    static const int MAX_RECORDERS = 16;
+
+private:
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    static void dumpAll();
+    static void onDumpSignal(int signum);
+    static void onFatalSignal(int signum);
+
+    std::vector<char> m_buffer;
+    std::atomic<unsigned long long> m_head; // bytes appended since creation
+    std::string m_basePath;
+    std::string m_extension;
+    std::atomic<unsigned int> m_dumpIndex;
+};
+
+}
+
+#endif /* FLIGHTRECORDER_H_ */
@@ -0,0 +1,258 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "api.h"
+#include "functioninstrumentation.h"
+#include "uprofileimpl.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <time.h>
+
+#if defined(__linux__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define NO_INSTRUMENT __attribute__((no_instrument_function))
+
+namespace uprofile
+{
+
+const int FunctionInstrumentation::MAX_DEPTH;
+const int FunctionInstrumentation::CACHE_SIZE;
+
+namespace
+{
+struct Frame {
+    void* function;
+    unsigned long long begin; // ns
+};
+struct CallStack {
+    int depth;
+    int tid;
+    bool inHook; // the hook itself may run instrumented code (e.g. a GPU monitor)
+    Frame frames[FunctionInstrumentation::MAX_DEPTH];
+};
+__thread CallStack t_stack;
+// Checked first by the hooks: the only cost of an instrumented call when not recording
+std::atomic<bool> g_active(false);
+
+NO_INSTRUMENT inline unsigned long long now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+}
+
+NO_INSTRUMENT FunctionInstrumentation& FunctionInstrumentation::instance()
+{
+    // Never destroyed: instrumented functions may still run during static destruction
+    static FunctionInstrumentation* instrumentation = new FunctionInstrumentation;
+    return *instrumentation;
+}
+
+NO_INSTRUMENT FunctionInstrumentation::FunctionInstrumentation() :
+    m_filtered(false),
+    m_minDuration(0),
+    m_profiler(nullptr)
+{
+    for (int i = 0; i < CACHE_SIZE; ++i) {
+        m_cache[i].function = 0;
+        m_cache[i].accepted = false;
+    }
+}
+
+NO_INSTRUMENT void FunctionInstrumentation::start(UProfileImpl* profiler, unsigned long long minDuration)
+{
+    m_minDuration = minDuration;
+    m_profiler = profiler;
+    g_active = true;
+}
+
+NO_INSTRUMENT void FunctionInstrumentation::stop(UProfileImpl* profiler)
+{
+    if (m_profiler.compare_exchange_strong(profiler, nullptr)) {
+        g_active = false;
+    }
+}
+
+NO_INSTRUMENT void FunctionInstrumentation::setFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_includes = includes;
+    m_excludes = excludes;
+    for (int i = 0; i < CACHE_SIZE; ++i) {
+        m_cache[i].function.store(0, std::memory_order_relaxed);
+    }
+    m_filtered = !includes.empty() || !excludes.empty();
+}
+
+NO_INSTRUMENT void FunctionInstrumentation::enter(void* function)
+{
+    CallStack& stack = t_stack;
+    if (stack.inHook || (m_filtered.load(std::memory_order_relaxed) && !accepts(function))) {
+        return;
+    }
+    if (stack.depth < MAX_DEPTH) {
+        stack.frames[stack.depth].function = function;
+        stack.frames[stack.depth].begin = now();
+    }
+    stack.depth++;
+}
+
+NO_INSTRUMENT void FunctionInstrumentation::exit(void* function)
+{
+    CallStack& stack = t_stack;
+    if (stack.depth == 0 || stack.inHook) {
+        return;
+    }
+    if (stack.depth > MAX_DEPTH) {
+        stack.depth--;
+        return;
+    }
+
+    // Filtered out functions are not on the stack. Frames left by a longjmp() are skipped.
+    int index = stack.depth - 1;
+    while (index >= 0 && index >= stack.depth - 4 && stack.frames[index].function != function) {
+        --index;
+    }
+    if (index < 0 || stack.frames[index].function != function) {
+        return;
+    }
+    stack.depth = index;
+
+    unsigned long long duration = now() - stack.frames[index].begin;
+    if (duration < m_minDuration.load(std::memory_order_relaxed)) {
+        return;
+    }
+    UProfileImpl* profiler = m_profiler.load(std::memory_order_acquire);
+    if (!profiler) {
+        return;
+    }
+    stack.inHook = true;
+#if defined(__linux__)
+    if (stack.tid == 0) {
+        stack.tid = static_cast<int>(syscall(SYS_gettid));
+    }
+#endif
+    profiler->writeFunctionCall(location(function), duration, stack.tid);
+    stack.inHook = false;
+}
+
+NO_INSTRUMENT bool FunctionInstrumentation::accepts(void* function)
+{
+    uintptr_t key = reinterpret_cast<uintptr_t>(function);
+    size_t slot = (key >> 4) & (CACHE_SIZE - 1);
+    for (int i = 0; i < CACHE_SIZE; ++i) {
+        CacheEntry& entry = m_cache[(slot + i) & (CACHE_SIZE - 1)];
+        uintptr_t cached = entry.function.load(std::memory_order_acquire);
+        if (cached == key) {
+            return entry.accepted.load(std::memory_order_relaxed);
+        }
+        if (cached == 0) {
+            break;
+        }
+    }
+
+    // First call of the function: match the filters and cache the decision
+    t_stack.inHook = true;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool accepted = matchFilters(function);
+    for (int i = 0; i < CACHE_SIZE; ++i) {
+        CacheEntry& entry = m_cache[(slot + i) & (CACHE_SIZE - 1)];
+        uintptr_t cached = entry.function.load(std::memory_order_relaxed);
+        if (cached == key) {
+            break;
+        }
+        if (cached == 0) {
+            entry.accepted.store(accepted, std::memory_order_relaxed);
+            entry.function.store(key, std::memory_order_release);
+            break;
+        }
+    }
+    t_stack.inHook = false;
+    return accepted;
+}
+
+NO_INSTRUMENT bool FunctionInstrumentation::matchFilters(void* function)
+{
+    std::string symbol, module;
+#if defined(__linux__)
+    Dl_info info;
+    if (dladdr(function, &info)) {
+        if (info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            symbol = status == 0 && demangled ? demangled : info.dli_sname;
+            free(demangled);
+        }
+        module = info.dli_fname ? info.dli_fname : "";
+    }
+#endif
+    auto matches = [&](const std::vector<std::string>& patterns) {
+        for (auto it = patterns.cbegin(); it != patterns.cend(); ++it) {
+            if (symbol.find(*it) != std::string::npos || module.find(*it) != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    };
+    return (m_includes.empty() || matches(m_includes)) && !matches(m_excludes);
+}
+
+NO_INSTRUMENT const std::string& FunctionInstrumentation::location(void* function)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_locations.find(function);
+    if (it != m_locations.end()) {
+        return it->second;
+    }
+
+    std::ostringstream location;
+#if defined(__linux__)
+    Dl_info info;
+    if (dladdr(function, &info) && info.dli_fname) {
+        uintptr_t offset = reinterpret_cast<uintptr_t>(function);
+        // Addresses of a non position independent executable are already the ones of the file
+        if (static_cast<const ElfW(Ehdr)*>(info.dli_fbase)->e_type != ET_EXEC) {
+            offset -= reinterpret_cast<uintptr_t>(info.dli_fbase);
+        }
+        location << info.dli_fname << "+0x" << std::hex << offset;
+    } else {
+        location << function;
+    }
+#else
+    location << function;
+#endif
+    return m_locations[function] = location.str();
+}
+
+}
+
+extern "C" {
+
+UPROFAPI NO_INSTRUMENT void __cyg_profile_func_enter(void* function, void* /*callSite*/)
+{
+    if (uprofile::g_active.load(std::memory_order_relaxed)) {
+        uprofile::FunctionInstrumentation::instance().enter(function);
+    }
+}
+
+UPROFAPI NO_INSTRUMENT void __cyg_profile_func_exit(void* function, void* /*callSite*/)
+{
+    if (uprofile::g_active.load(std::memory_order_relaxed)) {
+        uprofile::FunctionInstrumentation::instance().exit(function);
+    }
+}
+}
@@ -0,0 +1,78 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef FUNCTIONINSTRUMENTATION_H_
+#define FUNCTIONINSTRUMENTATION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+class UProfileImpl;
+
+/**
+ * Record the slow function calls of code compiled with -finstrument-functions
+ *
+ * Entered functions are pushed on a per-thread stack keyed by their address.
+ * On exit, a call lasting at least the minimal duration is recorded with the
+ * location of the function ('<module>+0x<offset>'), symbolized offline by the
+ * analysis tools.
+ *
+ * Include/exclude filters are matched against the symbol and module of each
+ * function once: decisions are cached in a lock-free table so that a filtered
+ * out call only costs a lookup.
+ */
+class FunctionInstrumentation
+{
+public:
+    static FunctionInstrumentation& instance();
+
+    void start(UProfileImpl* profiler, unsigned long long minDuration /* ns */);
+    // Only stop if the calls are recorded by this profiler
+    void stop(UProfileImpl* profiler);
+    // Patterns are matched as substrings of the demangled symbol or of the module path
+    void setFilters(const std::vector<std::string>& includes, const std::vector<std::string>& excludes);
+
+    void enter(void* function);
+    void exit(void* function);
+
+    static const int MAX_DEPTH = 256;
+    static const int CACHE_SIZE = 16384; // filter decisions (power of 2)
+
+private:
+    FunctionInstrumentation();
+
+    bool accepts(void* function);
+    bool matchFilters(void* function);
+    const std::string& location(void* function);
+
+    std::atomic<bool> m_filtered; // whether filters are set
+    std::atomic<unsigned long long> m_minDuration;
+    std::atomic<UProfileImpl*> m_profiler;
+
+    struct CacheEntry {
+        std::atomic<uintptr_t> function;
+        std::atomic<bool> accepted;
+    };
+    CacheEntry m_cache[CACHE_SIZE];
+    std::vector<std::string> m_includes;
+    std::vector<std::string> m_excludes;
+    std::map<void*, std::string> m_locations;
+    std::mutex m_mutex;
+};
+
+}
+
+#endif /* FUNCTIONINSTRUMENTATION_H_ */
@@ -0,0 +1,109 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "histogram.h"
+
+#include <cmath>
+
+namespace uprofile
+{
+
+int Histogram::bucketIndex(double value)
+{
+    if (!(value > 0.)) {
+        return 0;
+    }
+    // value = mantissa * 2^exponent with mantissa in [0.5, 1)
+    int exponent = 0;
+    double mantissa = std::frexp(value, &exponent);
+    int sub = static_cast<int>((mantissa - 0.5) * 2 * SUB_BUCKETS);
+    int index = (exponent + EXPONENT_OFFSET) * SUB_BUCKETS + sub;
+    if (index < 0) {
+        return 0;
+    }
+    return index < BUCKETS_NUMBER ? index : BUCKETS_NUMBER - 1;
+}
+
+double Histogram::bucketUpperBound(int index)
+{
+    int exponent = index / SUB_BUCKETS - EXPONENT_OFFSET;
+    int sub = index % SUB_BUCKETS;
+    return std::ldexp(0.5 + (sub + 1) / (2. * SUB_BUCKETS), exponent);
+}
+
+Histogram::Histogram() :
+    m_buckets(BUCKETS_NUMBER, 0)
+{
+}
+
+void Histogram::record(double value)
+{
+    m_buckets[bucketIndex(value)]++;
+    m_count++;
+    m_sum += value;
+}
+
+void Histogram::addBucket(int index, unsigned long long count)
+{
+    m_buckets[index] += count;
+    m_count += count;
+}
+
+void Histogram::addSum(double sum)
+{
+    m_sum += sum;
+}
+
+void Histogram::merge(const Histogram& other)
+{
+    for (int i = 0; i < BUCKETS_NUMBER; ++i) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+}
+
+Histogram Histogram::since(const Histogram& previous) const
+{
+    Histogram delta;
+    for (int i = 0; i < BUCKETS_NUMBER; ++i) {
+        delta.m_buckets[i] = m_buckets[i] >= previous.m_buckets[i] ? m_buckets[i] - previous.m_buckets[i] : 0;
+    }
+    delta.m_count = m_count >= previous.m_count ? m_count - previous.m_count : 0;
+    delta.m_sum = m_sum - previous.m_sum;
+    return delta;
+}
+
+void Histogram::reset()
+{
+    m_buckets.assign(BUCKETS_NUMBER, 0);
+    m_count = 0;
+    m_sum = 0.;
+}
+
+double Histogram::percentile(double p) const
+{
+    if (m_count == 0) {
+        return 0.;
+    }
+    unsigned long long rank = static_cast<unsigned long long>(std::ceil(p / 100. * m_count));
+    if (rank == 0) {
+        rank = 1;
+    }
+    unsigned long long cumulated = 0;
+    for (int i = 0; i < BUCKETS_NUMBER; ++i) {
+        cumulated += m_buckets[i];
+        if (cumulated >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BUCKETS_NUMBER - 1);
+}
+
+}
@@ -0,0 +1,61 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Histogram of positive values with log-linear buckets
+ *
+ * Each power of two is split into SUB_BUCKETS linear buckets, so that
+ * percentiles are estimated with a relative error below 1 / SUB_BUCKETS.
+ */
+class Histogram
+{
+public:
+    static const int SUB_BUCKETS = 4;
+    static const int EXPONENT_OFFSET = 32; // smallest bucket holds values around 2^-32
+    static const int BUCKETS_NUMBER = 64 * SUB_BUCKETS;
+
+    static int bucketIndex(double value);
+    static double bucketUpperBound(int index);
+
+    Histogram();
+
+    void record(double value);
+    // Used to rebuild a histogram from its buckets
+    void addBucket(int index, unsigned long long count);
+    void addSum(double sum);
+    void merge(const Histogram& other);
+    // Return the histogram of the values recorded since 'previous' (a former copy of this histogram)
+    Histogram since(const Histogram& previous) const;
+    void reset();
+
+    unsigned long long count() const { return m_count; }
+    double sum() const { return m_sum; }
+    double average() const { return m_count > 0 ? m_sum / m_count : 0.; }
+    unsigned long long bucketCount(int index) const { return m_buckets[index]; }
+    // Upper bound of the bucket holding the given percentile (between 0 and 100)
+    double percentile(double p) const;
+    double max() const { return percentile(100.); }
+
+private:
+    std::vector<unsigned long long> m_buckets;
+    unsigned long long m_count = 0;
+    double m_sum = 0.;
+};
+
+}
+
+#endif /* HISTOGRAM_H_ */
@@ -0,0 +1,171 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "processmonitor.h"
+#include "systemroot.h"
+
+#include <algorithm>
+#include <set>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+ProcessMonitor::ProcessMonitor(const std::vector<int>& pids, bool descendants) :
+    m_roots(pids),
+    m_descendants(descendants),
+    m_ticksPerSecond(100.),
+    m_pageSize(4)
+{
+#if defined(__linux__)
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) {
+        m_ticksPerSecond = static_cast<double>(ticks);
+    }
+    m_pageSize = getpagesize() / 1024;
+    // PID 0 stands for the current process
+    std::replace(m_roots.begin(), m_roots.end(), 0, static_cast<int>(getpid()));
+#endif
+    for (auto it = m_roots.cbegin(); it != m_roots.cend(); ++it) {
+        addProcess(*it);
+    }
+    m_lastTime = std::chrono::steady_clock::now();
+}
+
+void ProcessMonitor::addProcess(int pid)
+{
+    std::string dir = SystemRoot::path("/proc/" + std::to_string(pid));
+    Process process;
+    process.stat.reset(new ProcFile(dir + "/stat"));
+    if (!process.stat->isOpen()) {
+        return;
+    }
+    process.smaps.reset(new ProcFile(dir + "/smaps_rollup"));
+    process.usage.pid = pid;
+    m_processes[pid] = std::move(process);
+}
+
+void ProcessMonitor::readChildren(int pid, std::vector<int>& children)
+{
+#if defined(__linux__)
+    // Children are listed by the thread which created them
+    std::string taskDir = SystemRoot::path("/proc/" + std::to_string(pid) + "/task");
+    DIR* dir = opendir(taskDir.c_str());
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        ProcFile file(dirfd(dir), std::string(entry->d_name) + "/children");
+        const char* pos = file.read();
+        while (pos && *pos != '\0' && *pos != '\n') {
+            unsigned long long child = 0;
+            const char* next = ProcFile::parseNumber(pos, child);
+            if (next == pos) {
+                break;
+            }
+            children.push_back(static_cast<int>(child));
+            pos = ProcFile::skipSpaces(next);
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+void ProcessMonitor::discoverDescendants()
+{
+    std::set<int> tree;
+    std::vector<int> pending(m_roots);
+    while (!pending.empty()) {
+        int pid = pending.back();
+        pending.pop_back();
+        if (tree.insert(pid).second) {
+            readChildren(pid, pending);
+        }
+    }
+
+    for (auto it = tree.cbegin(); it != tree.cend(); ++it) {
+        if (m_processes.find(*it) == m_processes.end()) {
+            addProcess(*it);
+        }
+    }
+    // Processes which left the tree (like orphans re-parented to init) are no longer monitored
+    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
+        if (tree.find(it->first) == tree.end()) {
+            it->second.alive = false;
+        }
+    }
+}
+
+const std::vector<const ProcessMonitor::ProcessUsage*>& ProcessMonitor::sample()
+{
+    if (m_descendants) {
+        discoverDescendants();
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastTime).count();
+    m_lastTime = now;
+
+    m_result.clear();
+    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
+        Process& process = it->second;
+        // Fields following the state start at the 4th: utime is the 14th, stime the 15th,
+        // num_threads the 20th and rss (in pages) the 24th
+        unsigned long long fields[21] = {0};
+        char state = '?';
+        if (!process.alive || !ProcFile::parseStat(process.stat->read(), process.usage.name, state, fields, 21) || state == 'Z') {
+            // Exited (or zombie) process
+            process.alive = false;
+            continue;
+        }
+
+        unsigned long long ticks = fields[10] + fields[11];
+        bool valid = !process.first && elapsed > 0. && ticks >= process.lastTicks;
+        process.usage.usage = valid ? 100. * (ticks - process.lastTicks) / m_ticksPerSecond / elapsed : 0.;
+        process.lastTicks = ticks;
+        process.first = false;
+        process.usage.threads = fields[16];
+        process.usage.rss = fields[20] * m_pageSize;
+
+        // smaps_rollup dumps the following info (in kB):
+        // 00400000-7ffd8a5fe000 ---p 00000000 00:00 0                              [rollup]
+        // Rss:                2936 kB
+        // Pss:                 654 kB
+        process.usage.pss = 0;
+        const char* pos = process.smaps->read();
+        while (pos && *pos != '\0') {
+            if (ProcFile::wordLength(pos) == 3 && pos[0] == 'P' && pos[1] == 's' && pos[2] == 's') {
+                ProcFile::parseNumber(pos + 4, process.usage.pss);
+                break;
+            }
+            pos = ProcFile::nextLine(pos);
+        }
+        m_result.push_back(&process.usage);
+    }
+
+    for (auto it = m_processes.begin(); it != m_processes.end();) {
+        if (!it->second.alive) {
+            // An exited root is forgotten so that a new process reusing its PID is not monitored
+            m_roots.erase(std::remove(m_roots.begin(), m_roots.end(), it->first), m_roots.end());
+            it = m_processes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return m_result;
+}
+
+}
@@ -0,0 +1,80 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef PROCESSMONITOR_H_
+#define PROCESSMONITOR_H_
+
+#include "procfile.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Memory and CPU usage of a set of processes (/proc/<pid>/stat and smaps_rollup)
+ *
+ * Processes are either a fixed list of PIDs or a process and all its
+ * descendants (discovered through the /proc/<pid>/task/<tid>/children files).
+ *
+ * The files of a process are opened once when the process is discovered.
+ * Reading them fails as soon as the process exits, even if its PID is
+ * reused later, so that a new process is never mixed with an exited one.
+ */
+class ProcessMonitor
+{
+public:
+    struct ProcessUsage {
+        int pid = 0;
+        std::string name;
+        double usage = 0.;          // percentage of one CPU since the previous sample
+        unsigned long long rss = 0; // KiB
+        unsigned long long pss = 0; // KiB (0 if not readable)
+        unsigned long long threads = 0;
+    };
+
+    // Monitor the given processes (0 for the current one) or, if descendants is true,
+    // the given processes and all their descendants
+    ProcessMonitor(const std::vector<int>& pids, bool descendants);
+
+    const std::vector<const ProcessUsage*>& sample();
+
+private:
+    ProcessMonitor(const ProcessMonitor&) = delete;
+    ProcessMonitor& operator=(const ProcessMonitor&) = delete;
+
+    struct Process {
+        std::unique_ptr<ProcFile> stat;
+        std::unique_ptr<ProcFile> smaps;
+        ProcessUsage usage;
+        unsigned long long lastTicks = 0;
+        bool first = true;
+        bool alive = true;
+    };
+
+    void addProcess(int pid);
+    void discoverDescendants();
+    static void readChildren(int pid, std::vector<int>& children);
+
+    std::vector<int> m_roots;
+    bool m_descendants;
+    std::map<int, Process> m_processes;
+    std::vector<const ProcessUsage*> m_result;
+    std::chrono::steady_clock::time_point m_lastTime;
+    double m_ticksPerSecond;
+    long m_pageSize; // KiB
+};
+
+}
+
+#endif /* PROCESSMONITOR_H_ */
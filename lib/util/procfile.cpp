@@ -0,0 +1,164 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "procfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+static const size_t INITIAL_BUFFER_SIZE = 4096;
+
+ProcFile::ProcFile(const std::string& path) :
+    m_fd(-1),
+    m_buffer(INITIAL_BUFFER_SIZE)
+{
+#if defined(__linux__)
+    m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+ProcFile::ProcFile(int dirFd, const std::string& path) :
+    m_fd(-1),
+    m_buffer(INITIAL_BUFFER_SIZE)
+{
+#if defined(__linux__)
+    m_fd = openat(dirFd, path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+ProcFile::~ProcFile()
+{
+#if defined(__linux__)
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+#endif
+}
+
+const char* ProcFile::read()
+{
+#if defined(__linux__)
+    if (m_fd < 0) {
+        return nullptr;
+    }
+
+    // Pseudo files are generated at each read from offset 0
+    size_t size = 0;
+    while (true) {
+        ssize_t nbBytes = pread(m_fd, &m_buffer[size], m_buffer.size() - size - 1, size);
+        if (nbBytes < 0) {
+            return nullptr;
+        }
+        if (nbBytes == 0) {
+            break;
+        }
+        size += nbBytes;
+        if (size + 1 == m_buffer.size()) {
+            // Content does not fit: grow the buffer and read it again
+            m_buffer.resize(m_buffer.size() * 2);
+            size = 0;
+        }
+    }
+    m_buffer[size] = '\0';
+    return &m_buffer[0];
+#else
+    return nullptr;
+#endif
+}
+
+const char* ProcFile::skipSpaces(const char* pos)
+{
+    while (*pos == ' ' || *pos == '\t') {
+        ++pos;
+    }
+    return pos;
+}
+
+const char* ProcFile::nextLine(const char* pos)
+{
+    while (*pos != '\0' && *pos != '\n') {
+        ++pos;
+    }
+    return *pos == '\n' ? pos + 1 : pos;
+}
+
+const char* ProcFile::parseNumber(const char* pos, unsigned long long& value)
+{
+    pos = skipSpaces(pos);
+    value = 0;
+    while (*pos >= '0' && *pos <= '9') {
+        value = value * 10 + (*pos - '0');
+        ++pos;
+    }
+    return pos;
+}
+
+const char* ProcFile::parseDecimal(const char* pos, double& value)
+{
+    unsigned long long integer = 0;
+    pos = parseNumber(pos, integer);
+    value = static_cast<double>(integer);
+    if (*pos == '.') {
+        ++pos;
+        for (double unit = 0.1; *pos >= '0' && *pos <= '9'; unit /= 10., ++pos) {
+            value += (*pos - '0') * unit;
+        }
+    }
+    return pos;
+}
+
+bool ProcFile::parseStat(const char* content, std::string& name, char& state, unsigned long long* fields, size_t nbFields)
+{
+    // stat dumps the following info:
+    // 1234 (process name) S 1 1234 1234 0 -1 4194560 1140 0 0 0 <utime> <stime> ...
+    // The name can hold spaces and parenthesis: it ends at the last ')'
+    const char* nameBegin = content ? strchr(content, '(') : nullptr;
+    const char* nameEnd = content ? strrchr(content, ')') : nullptr;
+    if (!nameBegin || !nameEnd || nameEnd < nameBegin) {
+        return false;
+    }
+
+    size_t nameLength = nameEnd - nameBegin - 1;
+    if (name.size() != nameLength || name.compare(0, nameLength, nameBegin + 1, nameLength) != 0) {
+        // Only allocate when the process has been (re)named
+        name.assign(nameBegin + 1, nameLength);
+        std::replace(name.begin(), name.end(), ';', '_');
+    }
+
+    const char* pos = skipSpaces(nameEnd + 1);
+    state = *pos != '\0' ? *pos++ : '?';
+    for (size_t i = 0; i < nbFields; ++i) {
+        // Some fields (like the priority) can be negative: only their absolute value is kept
+        pos = skipSpaces(pos);
+        if (*pos == '-') {
+            ++pos;
+        }
+        pos = parseNumber(pos, fields[i]);
+    }
+    return true;
+}
+
+size_t ProcFile::wordLength(const char* pos)
+{
+    size_t length = 0;
+    while (pos[length] != '\0' && pos[length] != ' ' && pos[length] != '\t' && pos[length] != ':' && pos[length] != '\n') {
+        ++length;
+    }
+    return length;
+}
+
+}
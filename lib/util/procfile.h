@@ -0,0 +1,59 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef PROCFILE_H_
+#define PROCFILE_H_
+
+#include <string>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Pseudo file (procfs, sysfs) read periodically
+ *
+ * The file is opened once and read from its beginning into a buffer
+ * which only grows if the file does not fit in it, so that reading
+ * and parsing a sample does not allocate.
+ */
+class ProcFile
+{
+public:
+    explicit ProcFile(const std::string& path);
+    // Open a file relative to an opened directory
+    ProcFile(int dirFd, const std::string& path);
+    ~ProcFile();
+
+    bool isOpen() const { return m_fd >= 0; }
+    // Return the null terminated content of the file, nullptr on error
+    const char* read();
+
+    // Allocation-free parsing helpers, they return the position following the parsed item
+    static const char* skipSpaces(const char* pos);
+    static const char* nextLine(const char* pos);
+    static const char* parseNumber(const char* pos, unsigned long long& value);
+    static const char* parseDecimal(const char* pos, double& value);
+    // Parse a /proc/<pid>/stat line (see proc(5)): the process name, its state and the numeric fields
+    // following the state (fields[0] is the 4th field: the parent pid) up to nbFields
+    static bool parseStat(const char* content, std::string& name, char& state, unsigned long long* fields, size_t nbFields);
+    // Return the length of the word (up to a space, ':' or end of line) starting at pos
+    static size_t wordLength(const char* pos);
+
+private:
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+
+    int m_fd;
+    std::vector<char> m_buffer;
+};
+
+}
+
+#endif /* PROCFILE_H_ */
@@ -0,0 +1,69 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "rollup.h"
+
+#include <algorithm>
+
+namespace uprofile
+{
+
+const unsigned long long RollupAggregator::RESOLUTIONS[RollupAggregator::RESOLUTIONS_NUMBER] = {
+    1000,   // 1 s
+    60000,  // 1 min
+    3600000 // 1 h
+};
+
+RollupAggregator::RollupAggregator(const Callback& callback) :
+    m_callback(callback)
+{
+}
+
+void RollupAggregator::add(const std::string& metric, const std::string& instance, const std::string& field, double value, unsigned long long timestamp)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    Serie& serie = m_series[std::make_tuple(metric, instance, field)];
+    for (int i = 0; i < RESOLUTIONS_NUMBER; ++i) {
+        Bucket& bucket = serie.buckets[i];
+        unsigned long long start = timestamp - (timestamp % RESOLUTIONS[i]);
+        if (bucket.count > 0 && bucket.start != start) {
+            // Sample belongs to a new bucket: close the current one
+            m_callback(metric, instance, field, RESOLUTIONS[i], bucket);
+            bucket = Bucket();
+        }
+
+        if (bucket.count == 0) {
+            bucket.start = start;
+            bucket.min = value;
+            bucket.max = value;
+        } else {
+            bucket.min = std::min(bucket.min, value);
+            bucket.max = std::max(bucket.max, value);
+        }
+        bucket.sum += value;
+        bucket.last = value;
+        bucket.count++;
+    }
+}
+
+void RollupAggregator::flush()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_series.begin(); it != m_series.end(); ++it) {
+        for (int i = 0; i < RESOLUTIONS_NUMBER; ++i) {
+            Bucket& bucket = it->second.buckets[i];
+            if (bucket.count > 0) {
+                m_callback(std::get<0>(it->first), std::get<1>(it->first), std::get<2>(it->first), RESOLUTIONS[i], bucket);
+                bucket = Bucket();
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef ROLLUP_H_
+#define ROLLUP_H_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace uprofile
+{
+
+/**
+ * Round-robin like aggregation of monitored values
+ *
+ * Each serie (metric, instance, field) is aggregated into 1 s, 1 min and 1 h
+ * buckets. When a sample falls outside the current bucket of a resolution,
+ * the bucket is closed and handed to the callback.
+ */
+class RollupAggregator
+{
+public:
+    struct Bucket {
+        unsigned long long start = 0; // ms
+        double min = 0.;
+        double max = 0.;
+        double sum = 0.;
+        double last = 0.;
+        unsigned long long count = 0;
+    };
+
+    using Callback = std::function<void(const std::string& metric, const std::string& instance, const std::string& field,
+                                        unsigned long long resolution, const Bucket& bucket)>;
+
+    static const int RESOLUTIONS_NUMBER = 3;
+    static const unsigned long long RESOLUTIONS[RESOLUTIONS_NUMBER]; // bucket durations (in ms)
+
+    explicit RollupAggregator(const Callback& callback);
+
+    void add(const std::string& metric, const std::string& instance, const std::string& field, double value, unsigned long long timestamp);
+    // Emit all the pending (partially filled) buckets
+    void flush();
+
+private:
+    using SerieKey = std::tuple<std::string, std::string, std::string>;
+    struct Serie {
+        Bucket buckets[RESOLUTIONS_NUMBER];
+    };
+
+    std::mutex m_mutex;
+    std::map<SerieKey, Serie> m_series;
+    Callback m_callback;
+};
+
+}
+
+#endif /* ROLLUP_H_ */
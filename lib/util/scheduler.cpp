@@ -0,0 +1,170 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "scheduler.h"
+
+namespace uprofile
+{
+
+Scheduler::Scheduler() :
+    m_running(false),
+    m_threadExited(false)
+{
+}
+
+Scheduler::~Scheduler()
+{
+    clear();
+}
+
+void Scheduler::schedule(const std::string& name, int period, const Task& task)
+{
+    if (period <= 0 || !task) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    Entry& entry = m_tasks[name];
+    entry.period = period;
+    entry.task = task;
+    entry.next = Clock::now() + std::chrono::milliseconds(period);
+    if (!m_running) {
+        // The thread lifecycle is handled under the lock so that a single caller starts the thread
+        m_running = true;
+        if (m_thread && m_threadExited) {
+            // Stopped by clear() called from a task: the thread has left its loop
+            m_thread->join();
+            m_thread.reset();
+        }
+        if (!m_thread) {
+            m_threadExited = false;
+            m_thread.reset(new std::thread(&Scheduler::run, this));
+        }
+        // Otherwise the thread stopped from a task is still running it and keeps on scheduling
+    }
+    m_cond.notify_all();
+}
+
+bool Scheduler::setPeriod(const std::string& name, int period)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_tasks.find(name);
+    if (it == m_tasks.end() || period <= 0) {
+        return false;
+    }
+    it->second.next += std::chrono::milliseconds(period - it->second.period);
+    it->second.period = period;
+    m_cond.notify_all();
+    return true;
+}
+
+int Scheduler::period(const std::string& name) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_tasks.find(name);
+    return it != m_tasks.end() ? it->second.period : 0;
+}
+
+void Scheduler::remove(const std::string& name)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_tasks.erase(name);
+    if (std::this_thread::get_id() == m_taskThread) {
+        // Removed from a task
+        return;
+    }
+    m_cond.wait(lk, [&]() { return m_runningTask != name; });
+}
+
+void Scheduler::clear()
+{
+    std::unique_ptr<std::thread> thread;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_tasks.clear();
+        m_running = false;
+        // The thread is detached from the scheduler under the lock: it leaves its loop even if
+        // a task is scheduled again meanwhile, a new thread being started then
+        if (m_thread && m_thread->get_id() != std::this_thread::get_id()) {
+            thread = std::move(m_thread);
+        }
+        m_cond.notify_all();
+    }
+    if (thread) {
+        thread->join();
+    }
+}
+
+std::map<std::string, Scheduler::TaskStats> Scheduler::stats() const
+{
+    std::map<std::string, TaskStats> stats;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_tasks.cbegin(); it != m_tasks.cend(); ++it) {
+        stats[it->first] = it->second.stats;
+    }
+    return stats;
+}
+
+void Scheduler::run()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (m_running && isSchedulerThread()) {
+        if (m_tasks.empty()) {
+            m_cond.wait(lk);
+            continue;
+        }
+
+        auto due = m_tasks.begin();
+        for (auto it = m_tasks.begin(); it != m_tasks.end(); ++it) {
+            if (it->second.next < due->second.next) {
+                due = it;
+            }
+        }
+        if (due->second.next > Clock::now()) {
+            m_cond.wait_until(lk, due->second.next);
+            continue;
+        }
+
+        // Run the task without the lock so that tasks can be (re)scheduled meanwhile
+        std::string name = due->first;
+        Task task = due->second.task;
+        m_runningTask = name;
+        m_taskThread = std::this_thread::get_id();
+        lk.unlock();
+        Clock::time_point begin = Clock::now();
+        task();
+        Clock::time_point end = Clock::now();
+        lk.lock();
+        m_runningTask.clear();
+        m_taskThread = std::thread::id();
+        m_cond.notify_all();
+
+        auto it = m_tasks.find(name);
+        if (it != m_tasks.end()) {
+            it->second.stats.runs++;
+            it->second.stats.duration += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+            Clock::time_point now = Clock::now();
+            it->second.next += std::chrono::milliseconds(it->second.period);
+            if (it->second.next < now) {
+                // Late (e.g. slow task): skip the missed periods
+                it->second.next = now + std::chrono::milliseconds(it->second.period);
+            }
+        }
+    }
+    if (isSchedulerThread()) {
+        m_threadExited = true;
+    }
+}
+
+bool Scheduler::isSchedulerThread() const
+{
+    return m_thread && m_thread->get_id() == std::this_thread::get_id();
+}
+
+}
@@ -0,0 +1,82 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace uprofile
+{
+
+/**
+ * Periodic tasks run from a single thread
+ *
+ * Tasks are identified by a name. The thread is started with the first
+ * task and stopped by clear().
+ */
+class Scheduler
+{
+public:
+    using Task = std::function<void()>;
+
+    struct TaskStats {
+        unsigned long long runs;
+        unsigned long long duration; // ns spent running the task
+    };
+
+    Scheduler();
+    ~Scheduler();
+
+    // Add a task (or replace the task with the same name) called every 'period' ms
+    void schedule(const std::string& name, int period, const Task& task);
+    // Change the period of a task, return false if there is no such task
+    bool setPeriod(const std::string& name, int period);
+    // Return the period of a task, 0 if there is no such task
+    int period(const std::string& name) const;
+    // Remove a task, waiting for its completion if it is running
+    void remove(const std::string& name);
+    // Remove all tasks and stop the thread
+    void clear();
+    // Return the run statistics of the scheduled tasks
+    std::map<std::string, TaskStats> stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        int period;
+        Task task;
+        Clock::time_point next;
+        TaskStats stats = {0, 0};
+    };
+
+    void run();
+    // Whether the calling thread is the scheduler thread, to be called with the lock held
+    bool isSchedulerThread() const;
+
+    std::map<std::string, Entry> m_tasks;
+    std::string m_runningTask;
+    std::thread::id m_taskThread; // thread running m_runningTask
+    bool m_running;
+    bool m_threadExited; // the thread has left its loop and just needs to be joined
+    std::unique_ptr<std::thread> m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+}
+
+#endif /* SCHEDULER_H_ */
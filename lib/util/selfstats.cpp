@@ -0,0 +1,94 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "selfstats.h"
+
+#include <chrono>
+#include <new>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace uprofile
+{
+
+const int SelfStats::STRIPES;
+
+namespace
+{
+std::atomic<unsigned int> g_nextStripe(0);
+
+// Threads are spread over the stripes in turn
+unsigned int localStripe()
+{
+    static thread_local unsigned int stripe = g_nextStripe.fetch_add(1, std::memory_order_relaxed) % SelfStats::STRIPES;
+    return stripe;
+}
+}
+
+SelfStats::SelfStats()
+{
+    size_t size = STRIPES * sizeof(Stripe) + alignof(Stripe);
+    m_buffer.reset(new char[size]);
+    void* stripes = m_buffer.get();
+    std::align(alignof(Stripe), STRIPES * sizeof(Stripe), stripes, size);
+    m_stripes = static_cast<Stripe*>(stripes);
+    for (int i = 0; i < STRIPES; ++i) {
+        new (&m_stripes[i]) Stripe;
+        for (int j = 0; j < COUNTERS_NUMBER; ++j) {
+            m_stripes[i].values[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+SelfStats::~SelfStats()
+{
+    for (int i = 0; i < STRIPES; ++i) {
+        m_stripes[i].~Stripe();
+    }
+}
+
+void SelfStats::add(Counter counter, unsigned long long value)
+{
+    m_stripes[localStripe()].values[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+unsigned long long SelfStats::get(Counter counter) const
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < STRIPES; ++i) {
+        value += m_stripes[i].values[counter].load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+unsigned long long SelfStats::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long long SelfStats::threadCpuTime(std::thread* thread)
+{
+#if defined(__linux__)
+    clockid_t clock = CLOCK_THREAD_CPUTIME_ID;
+    struct timespec ts;
+    if (thread && pthread_getcpuclockid(thread->native_handle(), &clock) != 0) {
+        return 0;
+    }
+    if (clock_gettime(clock, &ts) == 0) {
+        return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    (void)thread;
+    return 0;
+}
+
+}
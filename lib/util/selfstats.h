@@ -0,0 +1,64 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SELFSTATS_H_
+#define SELFSTATS_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace uprofile
+{
+
+/**
+ * Overhead of a profiler, measured by the profiler itself
+ *
+ * Times spent in the API are added to striped counters, each stripe lying on
+ * its own cache line. Threads are spread over the stripes in turn: up to STRIPES
+ * threads, each one updates its own stripe, so measuring costs two clock reads
+ * and an uncontended atomic add. More threads share stripes, their adds possibly
+ * contending. Stripes are only summed when the statistics are dumped.
+ */
+class SelfStats
+{
+public:
+    enum Counter {
+        API_TIME,   // ns spent in timeBegin()/timeEnd()
+        WRITE_TIME, // ns spent encoding and dispatching events
+        FILTERED,   // samples not written (deadband, rollups without raw samples)
+        LOCK_WAIT,  // ns waited for the event writer lock, contended by the producers
+        COUNTERS_NUMBER
+    };
+
+    static const int STRIPES = 16;
+
+    SelfStats();
+    ~SelfStats();
+
+    void add(Counter counter, unsigned long long value);
+    unsigned long long get(Counter counter) const;
+
+    static unsigned long long now(); // ns (steady clock)
+    // CPU time (in ns) consumed by the given thread (the current one if null), 0 if not available
+    static unsigned long long threadCpuTime(std::thread* thread = nullptr);
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<unsigned long long> values[COUNTERS_NUMBER];
+    };
+
+    // Stripes are allocated apart, aligned on a cache line (new does not honour extended alignments in C++11)
+    std::unique_ptr<char[]> m_buffer;
+    Stripe* m_stripes;
+};
+
+}
+
+#endif /* SELFSTATS_H_ */
@@ -0,0 +1,250 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "shmsegment.h"
+#include "procfile.h"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+struct ShmSegment::Header {
+    unsigned long long magic;
+    unsigned int version;
+    unsigned int slotsNumber;
+    unsigned long long ringSize;
+    std::atomic<unsigned int> ready;
+};
+
+static const unsigned long long SEGMENT_MAGIC = 0x75707266736d6731ULL;
+static const unsigned int SEGMENT_VERSION = 1;
+// Header and slots are aligned on cache lines
+static const size_t HEADER_SIZE = 64;
+static const size_t SLOT_HEADER_SIZE = 64;
+static const int OPEN_TIMEOUT = 1000; // ms
+
+const unsigned int ShmSegment::DEFAULT_SLOTS_NUMBER;
+const size_t ShmSegment::DEFAULT_RING_SIZE;
+
+static size_t segmentSize(unsigned int slotsNumber, size_t ringSize)
+{
+    return HEADER_SIZE + slotsNumber * (SLOT_HEADER_SIZE + ringSize);
+}
+
+ShmSegment* ShmSegment::open(const std::string& name, unsigned int slotsNumber, size_t ringSize)
+{
+    static_assert(sizeof(Header) <= HEADER_SIZE && sizeof(Slot) <= SLOT_HEADER_SIZE, "Invalid segment layout");
+#if defined(__linux__)
+    bool creator = true;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd == -1 && errno == EEXIST) {
+        creator = false;
+        fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    }
+    if (fd == -1) {
+        std::cerr << "Cannot open shared memory segment " << name << ": " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    size_t size = 0;
+    if (creator) {
+        ringSize = (ringSize + SLOT_HEADER_SIZE - 1) / SLOT_HEADER_SIZE * SLOT_HEADER_SIZE;
+        size = segmentSize(slotsNumber, ringSize);
+        if (slotsNumber == 0 || ringSize == 0 || ftruncate(fd, size) == -1) {
+            std::cerr << "Cannot size shared memory segment " << name << std::endl;
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+    } else {
+        // Wait for the creator to size the segment
+        struct stat st;
+        for (int i = 0; i < OPEN_TIMEOUT / 10 && fstat(fd, &st) == 0 && st.st_size < static_cast<off_t>(HEADER_SIZE); ++i) {
+            usleep(10000);
+        }
+        size = fstat(fd, &st) == 0 ? st.st_size : 0;
+    }
+
+    void* address = size >= HEADER_SIZE ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (address == MAP_FAILED) {
+        std::cerr << "Cannot map shared memory segment " << name << std::endl;
+        return nullptr;
+    }
+
+    // Pages of a new segment are zero-filled: all slots are free
+    Header* header = static_cast<Header*>(address);
+    if (creator) {
+        header->magic = SEGMENT_MAGIC;
+        header->version = SEGMENT_VERSION;
+        header->slotsNumber = slotsNumber;
+        header->ringSize = ringSize;
+        header->ready.store(1, std::memory_order_release);
+    } else {
+        for (int i = 0; i < OPEN_TIMEOUT / 10 && header->ready.load(std::memory_order_acquire) == 0; ++i) {
+            usleep(10000);
+        }
+        if (header->ready.load(std::memory_order_acquire) == 0 || header->magic != SEGMENT_MAGIC || header->version != SEGMENT_VERSION ||
+            segmentSize(header->slotsNumber, header->ringSize) > size) {
+            std::cerr << "Invalid shared memory segment " << name << std::endl;
+            munmap(address, size);
+            return nullptr;
+        }
+    }
+    return new ShmSegment(address, size);
+#else
+    std::cerr << "Shared memory segments are not supported on this platform" << std::endl;
+    return nullptr;
+#endif
+}
+
+void ShmSegment::remove(const std::string& name)
+{
+#if defined(__linux__)
+    shm_unlink(name.c_str());
+#endif
+}
+
+ShmSegment::ShmSegment(void* address, size_t size) :
+    m_address(address),
+    m_size(size),
+    m_header(static_cast<Header*>(address))
+{
+}
+
+ShmSegment::~ShmSegment()
+{
+#if defined(__linux__)
+    munmap(m_address, m_size);
+#endif
+}
+
+unsigned int ShmSegment::slotsNumber() const
+{
+    return m_header->slotsNumber;
+}
+
+ShmSegment::Slot& ShmSegment::slot(unsigned int index)
+{
+    char* address = static_cast<char*>(m_address) + HEADER_SIZE + index * (SLOT_HEADER_SIZE + m_header->ringSize);
+    return *reinterpret_cast<Slot*>(address);
+}
+
+char* ShmSegment::ring(unsigned int index)
+{
+    return reinterpret_cast<char*>(&slot(index)) + SLOT_HEADER_SIZE;
+}
+
+int ShmSegment::claimSlot(int pid, unsigned long long startTime)
+{
+    for (unsigned int i = 0; i < slotsNumber(); ++i) {
+        Slot& s = slot(i);
+        int expected = 0;
+        if (s.pid.compare_exchange_strong(expected, pid)) {
+            s.closed.store(0);
+            s.dropped.store(0);
+            s.startTime.store(startTime, std::memory_order_release);
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void ShmSegment::closeSlot(unsigned int index)
+{
+    slot(index).closed.store(1, std::memory_order_release);
+}
+
+size_t ShmSegment::push(unsigned int index, const char* records, size_t size)
+{
+    Slot& s = slot(index);
+    const size_t ringSize = m_header->ringSize;
+    unsigned long long head = s.head.load(std::memory_order_relaxed);
+    unsigned long long tail = s.tail.load(std::memory_order_acquire);
+    size_t freeSize = ringSize - static_cast<size_t>(head - tail);
+
+    size_t length = size;
+    if (length > freeSize) {
+        // Only keep the whole records fitting in the ring, the others are dropped
+        length = 0;
+        for (size_t i = 0; i < freeSize; ++i) {
+            if (records[i] == '\n') {
+                length = i + 1;
+            }
+        }
+        unsigned long long dropped = 0;
+        for (size_t i = length; i < size; ++i) {
+            dropped += records[i] == '\n';
+        }
+        s.dropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
+
+    size_t position = static_cast<size_t>(head % ringSize);
+    size_t first = std::min(length, ringSize - position);
+    memcpy(ring(index) + position, records, first);
+    memcpy(ring(index), records + first, length - first);
+    // Publish the records
+    s.head.store(head + length, std::memory_order_release);
+    return length;
+}
+
+size_t ShmSegment::pop(unsigned int index, std::string& records)
+{
+    Slot& s = slot(index);
+    const size_t ringSize = m_header->ringSize;
+    unsigned long long head = s.head.load(std::memory_order_acquire);
+    unsigned long long tail = s.tail.load(std::memory_order_relaxed);
+    size_t length = static_cast<size_t>(head - tail);
+    if (length == 0 || length > ringSize) {
+        return 0;
+    }
+
+    size_t position = static_cast<size_t>(tail % ringSize);
+    size_t first = std::min(length, ringSize - position);
+    records.append(ring(index) + position, first);
+    records.append(ring(index), length - first);
+    s.tail.store(head, std::memory_order_release);
+    return length;
+}
+
+void ShmSegment::freeSlot(unsigned int index)
+{
+    Slot& s = slot(index);
+    s.head.store(0);
+    s.tail.store(0);
+    s.closed.store(0);
+    s.dropped.store(0);
+    s.startTime.store(0);
+    s.pid.store(0, std::memory_order_release);
+}
+
+unsigned long long ShmSegment::processStartTime(int pid)
+{
+    // starttime is the 22th field of the stat file (in clock ticks since boot)
+    ProcFile stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string name;
+    char state = '?';
+    unsigned long long fields[19] = {0};
+    if (!ProcFile::parseStat(stat.read(), name, state, fields, 19)) {
+        return 0;
+    }
+    return fields[18];
+}
+
+}
@@ -0,0 +1,82 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SHMSEGMENT_H_
+#define SHMSEGMENT_H_
+
+#include <atomic>
+#include <string>
+
+namespace uprofile
+{
+
+/**
+ * Named shared memory segment holding one events ring per producer process
+ *
+ * The segment starts with a header followed by a fixed number of slots. A
+ * process claims a free slot (atomic exchange of its PID) and is the single
+ * producer of the slot ring, the collector being its single consumer.
+ *
+ * The producer only publishes whole records (by moving the ring head after
+ * copying them), so that a producer crashing in the middle of a write never
+ * leaves a partial record visible. No lock is held in the segment.
+ */
+class ShmSegment
+{
+public:
+    struct Slot {
+        std::atomic<int> pid;                      // 0 if the slot is free
+        std::atomic<unsigned int> closed;          // set by the producer when it stops
+        std::atomic<unsigned long long> startTime; // start time of the producer process (to detect PID reuse)
+        std::atomic<unsigned long long> head;      // bytes written by the producer
+        std::atomic<unsigned long long> tail;      // bytes read by the collector
+        std::atomic<unsigned long long> dropped;   // records dropped because the ring was full
+    };
+
+    static const unsigned int DEFAULT_SLOTS_NUMBER = 64;
+    static const size_t DEFAULT_RING_SIZE = 256 * 1024;
+
+    // Open the segment, creating it with the given geometry if it does not exist yet
+    static ShmSegment* open(const std::string& name, unsigned int slotsNumber = DEFAULT_SLOTS_NUMBER, size_t ringSize = DEFAULT_RING_SIZE);
+    static void remove(const std::string& name);
+    ~ShmSegment();
+
+    unsigned int slotsNumber() const;
+    Slot& slot(unsigned int index);
+
+    // Producer side
+    int claimSlot(int pid, unsigned long long startTime);
+    void closeSlot(unsigned int index);
+    // Append whole records (up to the free space of the ring) and return the number of bytes written
+    size_t push(unsigned int index, const char* records, size_t size);
+
+    // Collector side
+    // Append the records published since the last call to 'records' and return the number of bytes read
+    size_t pop(unsigned int index, std::string& records);
+    void freeSlot(unsigned int index);
+
+    static unsigned long long processStartTime(int pid);
+
+private:
+    struct Header;
+
+    ShmSegment(void* address, size_t size);
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    char* ring(unsigned int index);
+
+    void* m_address;
+    size_t m_size;
+    Header* m_header;
+};
+
+}
+
+#endif /* SHMSEGMENT_H_ */
@@ -0,0 +1,536 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "stacksampler.h"
+#include "procfile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <cxxabi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace uprofile
+{
+
+const int StackSampler::MAX_DEPTH;
+const int StackSampler::SAMPLES_NUMBER;
+const int StackSampler::MAX_SPANS_DEPTH;
+
+static const int COLLECT_PERIOD = 100;  // ms
+static const int THREADS_SCAN_PERIOD = 10; // collects between two scans of the threads
+
+enum SampleState {
+    FREE,
+    WRITING,
+    READY
+};
+
+#if defined(__linux__)
+// Only lock-free atomics and thread locals with static TLS: they are read from the signal handler
+static std::atomic<bool> g_active(false);
+static std::atomic<StackSampler::Sample*> g_samples(nullptr);
+static std::atomic<unsigned int> g_writeIndex(0);
+static std::atomic<unsigned long long> g_dropped(0);
+static std::atomic<int> g_maxDepth(0);
+static std::atomic<bool> g_safeRead(false);
+static pid_t g_pid = 0;
+static struct sigaction g_previousAction;
+
+// Spans of the current thread, null until its first span
+static __thread StackSampler::ThreadSpans* t_spans __attribute__((tls_model("initial-exec")));
+
+// Read memory without faulting on an invalid address
+static bool readMemory(uintptr_t address, void* buffer, size_t size)
+{
+    struct iovec local = {buffer, size};
+    struct iovec remote = {reinterpret_cast<void*>(address), size};
+    return process_vm_readv(g_pid, &local, 1, &remote, 1, 0) == static_cast<ssize_t>(size);
+}
+
+static void onProfSignal(int /*signum*/, siginfo_t* /*info*/, void* context)
+{
+    StackSampler::Sample* samples = g_samples.load(std::memory_order_acquire);
+    if (!g_active.load(std::memory_order_relaxed) || !samples) {
+        return;
+    }
+    int savedErrno = errno;
+
+    StackSampler::Sample& sample = samples[g_writeIndex.fetch_add(1, std::memory_order_relaxed) % StackSampler::SAMPLES_NUMBER];
+    int expected = FREE;
+    if (!sample.state.compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+        // Collector late: the slot still holds a sample
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        errno = savedErrno;
+        return;
+    }
+
+    StackSampler::ThreadSpans* spans = t_spans;
+    int spansDepth = spans ? std::min(spans->depth.load(std::memory_order_acquire), StackSampler::MAX_SPANS_DEPTH) : 0;
+    sample.span = spansDepth > 0 ? spans->ids[spansDepth - 1].load(std::memory_order_relaxed) : -1;
+
+    uintptr_t pc = 0, fp = 0;
+    const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+#if defined(__x86_64__)
+    pc = uc->uc_mcontext.gregs[REG_RIP];
+    fp = uc->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+    pc = uc->uc_mcontext.pc;
+    fp = uc->uc_mcontext.regs[29];
+#else
+    (void)uc;
+#endif
+
+    int depth = 0;
+    const int maxDepth = g_maxDepth.load(std::memory_order_relaxed);
+    if (pc != 0) {
+        sample.frames[depth++] = reinterpret_cast<void*>(pc);
+    }
+    // Each frame starts with the frame pointer of the caller followed by the return address
+    while (depth < maxDepth && fp != 0 && fp % sizeof(void*) == 0 && g_safeRead.load(std::memory_order_relaxed)) {
+        uintptr_t frame[2];
+        if (!readMemory(fp, frame, sizeof(frame)) || frame[1] == 0) {
+            break;
+        }
+        sample.frames[depth++] = reinterpret_cast<void*>(frame[1]);
+        if (frame[0] <= fp) {
+            // Stack grows downwards: a caller frame is always above
+            break;
+        }
+        fp = frame[0];
+    }
+    sample.depth = depth;
+    sample.state.store(READY, std::memory_order_release);
+    errno = savedErrno;
+}
+#endif
+
+StackSampler& StackSampler::instance()
+{
+    // Never destroyed: the signal handler may still run during static destruction
+    static StackSampler* sampler = new StackSampler;
+    return *sampler;
+}
+
+StackSampler::StackSampler() :
+    m_running(false)
+{
+}
+
+StackSampler::ThreadSpans::ThreadSpans() :
+    depth(0)
+{
+}
+
+StackSampler::ThreadSpans::~ThreadSpans()
+{
+    StackSampler::instance().unregisterThread(this);
+}
+
+bool StackSampler::start(const std::string& foldedPath, int frequency, int maxDepth)
+{
+#if defined(__linux__)
+    if (m_running) {
+        std::cerr << "Stack sampling is already running" << std::endl;
+        return false;
+    }
+    if (frequency <= 0 || frequency > 1000000000) {
+        std::cerr << "Invalid stack sampling frequency: " << frequency << std::endl;
+        return false;
+    }
+
+    m_foldedPath = foldedPath;
+    m_frequency = frequency;
+    m_stacks.clear();
+    {
+        // Spans not ended during the previous sampling
+        std::lock_guard<std::mutex> guard(m_spansMutex);
+        for (auto it = m_threadSpans.begin(); it != m_threadSpans.end(); ++it) {
+            std::lock_guard<std::mutex> spansGuard((*it)->mutex);
+            (*it)->depth.store(0, std::memory_order_release);
+        }
+    }
+    if (!m_samples) {
+        // Allocated once and never freed: late signals may still write into it
+        m_samples.reset(new Sample[SAMPLES_NUMBER]);
+        for (int i = 0; i < SAMPLES_NUMBER; ++i) {
+            m_samples[i].state = FREE;
+        }
+        g_samples = m_samples.get();
+    }
+    g_pid = getpid();
+    g_maxDepth = std::max(1, std::min(maxDepth, static_cast<int>(MAX_DEPTH)));
+    g_dropped = 0;
+    uintptr_t probe = 0;
+    g_safeRead = readMemory(reinterpret_cast<uintptr_t>(&probe), &probe, sizeof(probe));
+    if (!g_safeRead) {
+        std::cerr << "process_vm_readv() is not permitted: only the sampled function is recorded" << std::endl;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &onProfSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &g_previousAction) == -1) {
+        std::cerr << "Failed to install the stack sampling signal handler" << std::endl;
+        return false;
+    }
+
+    g_active = true;
+    m_running = true;
+    m_collectorTid = 0;
+    updateTimers();
+    m_thread = std::thread(&StackSampler::run, this);
+    return true;
+#else
+    (void)foldedPath;
+    (void)frequency;
+    (void)maxDepth;
+    std::cerr << "Stack sampling is not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void StackSampler::stop()
+{
+#if defined(__linux__)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+
+    for (auto it = m_timers.begin(); it != m_timers.end(); ++it) {
+        timer_delete(static_cast<timer_t>(it->second));
+    }
+    m_timers.clear();
+    g_active = false;
+    // Signals still pending must not terminate the process (SIGPROF default action)
+    if (g_previousAction.sa_handler == SIG_DFL) {
+        g_previousAction.sa_handler = SIG_IGN;
+    }
+    sigaction(SIGPROF, &g_previousAction, NULL);
+
+    collect();
+    writeFoldedStacks();
+    if (g_dropped > 0) {
+        std::cerr << "Stack sampling dropped " << g_dropped << " samples" << std::endl;
+    }
+#endif
+}
+
+bool StackSampler::running() const
+{
+    return m_running;
+}
+
+void StackSampler::pushSpan(const std::string& title)
+{
+#if defined(__linux__)
+    if (!m_running) {
+        return;
+    }
+    ThreadSpans* spans = threadSpans();
+    auto known = spans->knownIds.find(title);
+    if (known == spans->knownIds.end()) {
+        std::lock_guard<std::mutex> guard(m_spansMutex);
+        auto it = m_spanIds.find(title);
+        if (it == m_spanIds.end()) {
+            it = m_spanIds.insert(std::make_pair(title, static_cast<int>(m_spanNames.size()))).first;
+            m_spanNames.push_back(title);
+        }
+        known = spans->knownIds.insert(*it).first;
+    }
+
+    std::lock_guard<std::mutex> guard(spans->mutex);
+    int depth = spans->depth.load(std::memory_order_relaxed);
+    if (depth < MAX_SPANS_DEPTH) {
+        spans->ids[depth].store(known->second, std::memory_order_relaxed);
+    }
+    // The signal handler of this thread must see the id before the new depth
+    spans->depth.store(depth + 1, std::memory_order_release);
+#else
+    (void)title;
+#endif
+}
+
+void StackSampler::popSpan(const std::string& title)
+{
+#if defined(__linux__)
+    if (!m_running) {
+        // Stacks are reset when sampling starts again
+        return;
+    }
+    ThreadSpans* spans = t_spans;
+    if (spans) {
+        auto known = spans->knownIds.find(title);
+        if (known != spans->knownIds.end()) {
+            std::lock_guard<std::mutex> guard(spans->mutex);
+            if (removeSpan(spans, known->second)) {
+                return;
+            }
+        }
+    }
+
+    // Span begun in another thread: it is dropped from the stack of that thread
+    std::lock_guard<std::mutex> guard(m_spansMutex);
+    auto it = m_spanIds.find(title);
+    if (it == m_spanIds.end()) {
+        return;
+    }
+    for (auto other = m_threadSpans.begin(); other != m_threadSpans.end(); ++other) {
+        if (*other == spans) {
+            continue;
+        }
+        std::lock_guard<std::mutex> otherGuard((*other)->mutex);
+        if (removeSpan(*other, it->second)) {
+            return;
+        }
+    }
+#else
+    (void)title;
+#endif
+}
+
+StackSampler::ThreadSpans* StackSampler::threadSpans()
+{
+    if (!t_spans) {
+        // Destroyed (and unregistered) when the thread exits
+        static thread_local ThreadSpans spans;
+        std::lock_guard<std::mutex> guard(m_spansMutex);
+        m_threadSpans.push_back(&spans);
+        t_spans = &spans;
+    }
+    return t_spans;
+}
+
+void StackSampler::unregisterThread(ThreadSpans* spans)
+{
+    t_spans = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> guard(m_spansMutex);
+    m_threadSpans.erase(std::remove(m_threadSpans.begin(), m_threadSpans.end(), spans), m_threadSpans.end());
+}
+
+bool StackSampler::removeSpan(ThreadSpans* spans, int id)
+{
+    int depth = spans->depth.load(std::memory_order_relaxed);
+    if (depth == 0) {
+        return false;
+    }
+    if (depth > MAX_SPANS_DEPTH) {
+        spans->depth.store(depth - 1, std::memory_order_release);
+        return true;
+    }
+    // Spans may not be ended in the reverse order of their beginning
+    for (int i = depth - 1; i >= 0; --i) {
+        if (spans->ids[i].load(std::memory_order_relaxed) == id) {
+            for (int j = i; j < depth - 1; ++j) {
+                spans->ids[j].store(spans->ids[j + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            spans->depth.store(depth - 1, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void StackSampler::run()
+{
+#if defined(__linux__)
+    m_collectorTid = static_cast<int>(syscall(SYS_gettid));
+#endif
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int iteration = 0;
+    while (m_running) {
+        m_cond.wait_for(lock, std::chrono::milliseconds(COLLECT_PERIOD), [this]() { return !m_running; });
+        lock.unlock();
+        collect();
+        if (++iteration % THREADS_SCAN_PERIOD == 0) {
+            updateTimers();
+        }
+        lock.lock();
+    }
+}
+
+void StackSampler::collect()
+{
+    for (int i = 0; i < SAMPLES_NUMBER; ++i) {
+        Sample& sample = m_samples[i];
+        if (sample.state.load(std::memory_order_acquire) != READY) {
+            continue;
+        }
+        std::pair<int, std::vector<void*>> key(sample.span, std::vector<void*>(sample.frames, sample.frames + sample.depth));
+        m_stacks[key]++;
+        sample.state.store(FREE, std::memory_order_release);
+    }
+}
+
+void StackSampler::updateTimers()
+{
+#if defined(__linux__)
+    // A thread is identified by its tid and its start time: a tid may be reused by a new thread
+    std::vector<ThreadKey> threads;
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        int tid = atoi(entry->d_name);
+        if (tid > 0 && tid != m_collectorTid) {
+            threads.push_back(ThreadKey(tid, threadStartTime(tid)));
+        }
+    }
+    closedir(dir);
+
+    // Timers of the exited threads
+    for (auto it = m_timers.begin(); it != m_timers.end();) {
+        if (std::find(threads.begin(), threads.end(), it->first) == threads.end()) {
+            timer_delete(static_cast<timer_t>(it->second));
+            it = m_timers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const long interval = 1000000000L / m_frequency; // ns
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        if (m_timers.count(*it)) {
+            continue;
+        }
+        const int tid = it->first;
+        // CPU clock of another thread (see MAKE_THREAD_CPUCLOCK in the kernel)
+        clockid_t clock = static_cast<clockid_t>((~static_cast<unsigned int>(tid) << 3) | 6);
+        struct sigevent event;
+        memset(&event, 0, sizeof(event));
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = tid;
+        timer_t timer;
+        if (timer_create(clock, &event, &timer) == -1) {
+            continue;
+        }
+        struct itimerspec spec;
+        spec.it_interval.tv_sec = interval / 1000000000L;
+        spec.it_interval.tv_nsec = interval % 1000000000L;
+        spec.it_value = spec.it_interval;
+        timer_settime(timer, 0, &spec, NULL);
+        m_timers[*it] = timer;
+    }
+#endif
+}
+
+unsigned long long StackSampler::threadStartTime(int tid)
+{
+    // starttime is the 22th field of the stat file (in clock ticks since boot)
+    ProcFile stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string name;
+    char state = '?';
+    unsigned long long fields[19] = {0};
+    if (!ProcFile::parseStat(stat.read(), name, state, fields, 19)) {
+        return 0;
+    }
+    return fields[18];
+}
+
+std::string StackSampler::symbolize(void* address, bool returnAddress)
+{
+    auto it = m_symbols.find(address);
+    if (it != m_symbols.end()) {
+        return it->second;
+    }
+
+    std::ostringstream symbol;
+#if defined(__linux__)
+    // A return address points after the call instruction, which may be the first one of another function
+    void* lookup = returnAddress ? static_cast<char*>(address) - 1 : address;
+    Dl_info info;
+    // info is left uninitialized when the address is in no module (JIT code, unmapped address)
+    bool found = dladdr(lookup, &info) != 0;
+    if (found && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        symbol << (status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+    } else if (found && info.dli_fname) {
+        // No symbol (static function or stripped binary): offset in the module for addr2line
+        const char* module = strrchr(info.dli_fname, '/');
+        symbol << (module ? module + 1 : info.dli_fname) << "+0x" << std::hex
+               << (reinterpret_cast<uintptr_t>(lookup) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+    } else {
+        symbol << address;
+    }
+#else
+    (void)returnAddress;
+    symbol << address;
+#endif
+    std::string name = symbol.str();
+    // ';' separates the frames of a folded stack
+    std::replace(name.begin(), name.end(), ';', ':');
+    m_symbols[address] = name;
+    return name;
+}
+
+void StackSampler::writeFoldedStacks()
+{
+    std::ofstream file(m_foldedPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << m_foldedPath << std::endl;
+        return;
+    }
+
+    // Stacks with the same symbols (different return addresses in a function) are merged
+    std::map<std::string, unsigned long long> folded;
+    for (auto it = m_stacks.begin(); it != m_stacks.end(); ++it) {
+        std::string line;
+        if (it->first.first >= 0) {
+            std::lock_guard<std::mutex> guard(m_spansMutex);
+            line = "[" + m_spanNames[it->first.first] + "]";
+        }
+        const std::vector<void*>& frames = it->first.second;
+        for (size_t i = frames.size(); i > 0; --i) {
+            if (!line.empty()) {
+                line += ';';
+            }
+            line += symbolize(frames[i - 1], i > 1);
+        }
+        if (!line.empty()) {
+            folded[line] += it->second;
+        }
+    }
+    for (auto it = folded.begin(); it != folded.end(); ++it) {
+        file << it->first << " " << it->second << "\n";
+    }
+}
+
+}
@@ -0,0 +1,112 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef STACKSAMPLER_H_
+#define STACKSAMPLER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace uprofile
+{
+
+/**
+ * Process-wide statistical profiler sampling the call stacks of all threads
+ *
+ * Each thread has a timer on its own CPU clock raising SIGPROF, so that
+ * threads are sampled proportionally to the CPU time they consume. The
+ * signal handler walks the frame pointers of the interrupted thread (memory
+ * being read with process_vm_readv() so that a broken frame chain cannot
+ * crash the process) and stores the return addresses into a preallocated slot
+ * of a lock-free buffer.
+ *
+ * A collector thread aggregates the samples and creates the timers of new
+ * threads. Addresses are only symbolized when writing the folded stacks file
+ * (one 'frame1;frame2;... count' line per stack, root first), the active span
+ * of the thread being the root frame.
+ *
+ * Code should be compiled with -fno-omit-frame-pointer to get full stacks.
+ */
+class StackSampler
+{
+public:
+    static StackSampler& instance();
+
+    bool start(const std::string& foldedPath, int frequency, int maxDepth);
+    // Stop sampling and write the folded stacks file
+    void stop();
+    bool running() const;
+
+    // Spans (timeBegin()/timeEnd()) active in the calling thread
+    void pushSpan(const std::string& title);
+    void popSpan(const std::string& title);
+
+    static const int MAX_DEPTH = 128;
+    static const int SAMPLES_NUMBER = 1024;
+    static const int MAX_SPANS_DEPTH = 16;
+
+    struct Sample {
+        std::atomic<int> state; // free, being written or ready
+        int span;
+        int depth;
+        void* frames[MAX_DEPTH];
+    };
+
+    // Spans active in a thread, read by the signal handler of the thread without locking
+    struct ThreadSpans {
+        ThreadSpans();
+        ~ThreadSpans();
+        std::mutex mutex; // taken by the thread and by popSpan() called from another thread
+        std::atomic<int> depth;
+        std::atomic<int> ids[MAX_SPANS_DEPTH];
+        std::map<std::string, int> knownIds; // span ids already looked up by the thread
+    };
+
+private:
+    StackSampler();
+
+    void run();
+    void collect();
+    void updateTimers();
+    static unsigned long long threadStartTime(int tid);
+    void writeFoldedStacks();
+    ThreadSpans* threadSpans();
+    void unregisterThread(ThreadSpans* spans);
+    static bool removeSpan(ThreadSpans* spans, int id);
+    std::string symbolize(void* address, bool returnAddress);
+
+    std::string m_foldedPath;
+    int m_frequency = 0;
+    std::unique_ptr<Sample[]> m_samples;
+    typedef std::pair<int, unsigned long long> ThreadKey; // (tid, start time)
+    std::map<ThreadKey, void*> m_timers; // timer of each thread
+    std::map<std::pair<int, std::vector<void*>>, unsigned long long> m_stacks; // (span, frames) -> number of samples
+    std::map<void*, std::string> m_symbols;
+    std::map<std::string, int> m_spanIds;
+    std::vector<std::string> m_spanNames;
+    std::vector<ThreadSpans*> m_threadSpans; // registered by the threads on their first span
+    std::mutex m_spansMutex;
+
+    std::atomic<bool> m_running;
+    int m_collectorTid = 0;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+}
+
+#endif /* STACKSAMPLER_H_ */
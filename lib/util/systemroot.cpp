@@ -0,0 +1,62 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "systemroot.h"
+
+#include <cstdlib>
+#include <mutex>
+
+namespace uprofile
+{
+
+namespace
+{
+std::mutex g_rootMutex;
+
+// "/" and "" both designate the running system
+void removeTrailingSlashes(std::string& path)
+{
+    while (!path.empty() && path.back() == '/') {
+        path.pop_back();
+    }
+}
+
+std::string& root()
+{
+    // Never destroyed: monitors may be created during static destruction
+    static std::string* root = nullptr;
+    if (!root) {
+        const char* value = std::getenv("UPROFILE_SYSTEM_ROOT");
+        root = new std::string(value ? value : "");
+        removeTrailingSlashes(*root);
+    }
+    return *root;
+}
+}
+
+void SystemRoot::set(const std::string& value)
+{
+    std::lock_guard<std::mutex> guard(g_rootMutex);
+    root() = value;
+    removeTrailingSlashes(root());
+}
+
+std::string SystemRoot::get()
+{
+    std::lock_guard<std::mutex> guard(g_rootMutex);
+    return root();
+}
+
+std::string SystemRoot::path(const std::string& path)
+{
+    std::lock_guard<std::mutex> guard(g_rootMutex);
+    return root() + path;
+}
+
+}
@@ -0,0 +1,36 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef SYSTEMROOT_H_
+#define SYSTEMROOT_H_
+
+#include <string>
+
+namespace uprofile
+{
+
+/**
+ * Directory under which the procfs and sysfs files are read
+ *
+ * Empty (the running system) unless set by the UPROFILE_SYSTEM_ROOT environment
+ * variable or set(). Monitors resolve their paths when they are created so a
+ * new root only applies to the monitors started afterwards.
+ */
+class SystemRoot
+{
+public:
+    static void set(const std::string& root);
+    static std::string get();
+    // Return the location of a system path (e.g. "/proc/stat") under the root
+    static std::string path(const std::string& path);
+};
+
+}
+
+#endif /* SYSTEMROOT_H_ */
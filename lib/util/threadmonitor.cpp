@@ -0,0 +1,133 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#include "threadmonitor.h"
+#include "systemroot.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace uprofile
+{
+
+ThreadMonitor::ThreadMonitor() :
+    m_ticksPerSecond(100.)
+{
+#if defined(__linux__)
+    m_taskDir = opendir(SystemRoot::path("/proc/self/task").c_str());
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) {
+        m_ticksPerSecond = static_cast<double>(ticks);
+    }
+#endif
+    m_lastTime = std::chrono::steady_clock::now();
+}
+
+ThreadMonitor::~ThreadMonitor()
+{
+#if defined(__linux__)
+    if (m_taskDir) {
+        closedir(m_taskDir);
+    }
+#endif
+}
+
+void ThreadMonitor::discoverThreads()
+{
+    for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
+        it->second.alive = false;
+    }
+
+#if defined(__linux__)
+    if (!m_taskDir) {
+        return;
+    }
+    rewinddir(m_taskDir);
+    while (struct dirent* entry = readdir(m_taskDir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue; // '.' and '..'
+        }
+        int tid = atoi(entry->d_name);
+        auto it = m_threads.find(tid);
+        if (it == m_threads.end()) {
+            // New thread: only open its stat file once
+            Thread& thread = m_threads[tid];
+            thread.stat.reset(new ProcFile(dirfd(m_taskDir), std::string(entry->d_name) + "/stat"));
+            thread.usage.tid = tid;
+            thread.alive = true;
+        } else {
+            it->second.alive = true;
+        }
+    }
+#endif
+
+    // Forget the threads which exited
+    for (auto it = m_threads.begin(); it != m_threads.end();) {
+        if (!it->second.alive) {
+            it = m_threads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const std::vector<const ThreadMonitor::ThreadUsage*>& ThreadMonitor::sample(size_t topN)
+{
+    discoverThreads();
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastTime).count();
+    m_lastTime = now;
+
+    m_result.clear();
+    for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
+        Thread& thread = it->second;
+        // Fields following the state start at the 4th: utime is the 14th, stime the 15th and processor the 39th
+        unsigned long long fields[36] = {0};
+        if (!ProcFile::parseStat(thread.stat->read(), thread.usage.name, thread.usage.state, fields, 36)) {
+            // Exited thread, whose TID may already be reused by a new thread
+            thread.alive = false;
+            continue;
+        }
+        unsigned long long ticks = fields[10] + fields[11];
+        thread.usage.cpu = static_cast<int>(fields[35]);
+        bool valid = !thread.first && elapsed > 0. && ticks >= thread.lastTicks;
+        thread.usage.usage = valid ? 100. * (ticks - thread.lastTicks) / m_ticksPerSecond / elapsed : 0.;
+        thread.lastTicks = ticks;
+        thread.first = false;
+        m_result.push_back(&thread.usage);
+    }
+
+    // The stat file of an exited thread stays unreadable: forget the thread so that a new thread
+    // reusing its TID is discovered with its own stat file
+    for (auto it = m_threads.begin(); it != m_threads.end();) {
+        if (!it->second.alive) {
+            it = m_threads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto byUsage = [](const ThreadUsage* a, const ThreadUsage* b) {
+        return a->usage > b->usage;
+    };
+    if (topN > 0 && topN < m_result.size()) {
+        std::partial_sort(m_result.begin(), m_result.begin() + topN, m_result.end(), byUsage);
+        m_result.resize(topN);
+    } else {
+        std::sort(m_result.begin(), m_result.end(), byUsage);
+    }
+    return m_result;
+}
+
+}
@@ -0,0 +1,77 @@
+// Software Name : cppuprofile
+// SPDX-FileCopyrightText: Copyright (c) 2026 Orange
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This software is distributed under the BSD License;
+// see the LICENSE file for more details.
+//
+// Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al.
+
+#ifndef THREADMONITOR_H_
+#define THREADMONITOR_H_
+
+#include "procfile.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#endif
+
+namespace uprofile
+{
+
+/**
+ * CPU usage of each thread of the process (/proc/self/task/<tid>/stat)
+ *
+ * The task directory is kept open and the stat file of each thread is only
+ * opened when the thread is discovered, so that a sample only costs one read
+ * per thread.
+ */
+class ThreadMonitor
+{
+public:
+    struct ThreadUsage {
+        int tid = 0;
+        std::string name;
+        double usage = 0.; // percentage of one CPU since the previous sample
+        int cpu = 0;       // CPU the thread last ran on
+        char state = '?';  // R (running), S (sleeping), D (disk sleep)...
+    };
+
+    ThreadMonitor();
+    ~ThreadMonitor();
+
+    // Return the usage of the 'topN' most consuming threads (all threads if 0), by decreasing usage
+    const std::vector<const ThreadUsage*>& sample(size_t topN);
+
+private:
+    ThreadMonitor(const ThreadMonitor&) = delete;
+    ThreadMonitor& operator=(const ThreadMonitor&) = delete;
+
+    struct Thread {
+        std::unique_ptr<ProcFile> stat;
+        ThreadUsage usage;
+        unsigned long long lastTicks = 0;
+        bool first = true;
+        bool alive = false;
+    };
+
+    void discoverThreads();
+
+#if defined(__linux__)
+    DIR* m_taskDir;
+#endif
+    std::map<int, Thread> m_threads;
+    std::vector<const ThreadUsage*> m_result;
+    std::chrono::steady_clock::time_point m_lastTime;
+    double m_ticksPerSecond;
+};
+
+}
+
+#endif /* THREADMONITOR_H_ */
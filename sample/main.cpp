@@ -13,6 +13,8 @@
 #include <uprofile.h>
 #if defined(GPU_MONITOR_NVIDIA)
 #include <monitors/nvidiamonitor.h>
+#else
+#include <monitors/drmmonitor.h>
 #endif
 
 void printSystemMemory()
@@ -37,9 +39,11 @@ int main(int argc, char* argv[])
     // --- START MONITORING ---
 #if defined(GPU_MONITOR_NVIDIA)
     uprofile::addGPUMonitor(new uprofile::NvidiaMonitor);
+#else
+    uprofile::addGPUMonitor(new uprofile::DrmMonitor);
+#endif
     uprofile::startGPUMemoryMonitoring(200);
     uprofile::startGPUUsageMonitoring(200);
-#endif
     uprofile::startCPUUsageMonitoring(200);
     uprofile::startSystemMemoryMonitoring(200);
     uprofile::startProcessMemoryMonitoring(200);
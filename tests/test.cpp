@@ -7,9 +7,35 @@
 //
 // Author: Cédric CHEDALEUX <cedric.chedaleux@orange.com> et al
 
+#include <algorithm>
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <fcntl.h>
+#include <functional>
+#include <monitors/cgroupmonitor.h>
+#include <monitors/drmmonitor.h>
+#include <map>
+#include <monitors/pressuremonitor.h>
+#include <profiledmutex.h>
+#include <sinks/callbacksink.h>
+#include <sinks/memorysink.h>
+#include <sinks/sharedmemorysink.h>
+#include <sinks/socketsink.h>
+#include <sharedmemorycollector.h>
+#include <pthread.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
 #include <uprofile.h>
+#if defined(GPU_MONITOR_NVIDIA)
+#include <monitors/nvidiamonitor.h>
+#endif
 
 static const std::string filename = "./test.log";
 
@@ -24,6 +50,86 @@ int fileSize(const std::string& filename) {
     return file.tellg();
 }
 
+// Fake procfs or sysfs tree, removed with the files written to it
+class FakeTree
+{
+public:
+    explicit FakeTree(const std::string& root) : m_root(root) { mkdir(root.c_str(), 0755); }
+
+    ~FakeTree()
+    {
+        for (auto it = m_paths.rbegin(); it != m_paths.rend(); ++it) {
+            std::remove(it->c_str());
+        }
+        rmdir(m_root.c_str());
+    }
+
+    // Write a file, creating its directories
+    void writeFile(const std::string& path, const std::string& content)
+    {
+        for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+            if (mkdir((m_root + path.substr(0, pos)).c_str(), 0755) == 0) {
+                m_paths.push_back(m_root + path.substr(0, pos));
+            }
+        }
+        std::ofstream(m_root + path) << content;
+        m_paths.push_back(m_root + path);
+    }
+
+private:
+    std::string m_root;
+    std::vector<std::string> m_paths; // created files and directories
+};
+
+// Read the monitored files under a fake root until the end of the test, even if it fails
+class SystemRootGuard
+{
+public:
+    explicit SystemRootGuard(const std::string& root) { uprofile::setSystemRoot(root); }
+    ~SystemRootGuard() { uprofile::setSystemRoot(""); }
+};
+
+// Custom monitor of two queues
+class QueueMonitor : public uprofile::IMetricMonitor
+{
+public:
+    uprofile::MetricSchema schema() const override
+    {
+        uprofile::MetricSchema schema;
+        schema.name = "queue";
+        schema.instances = {"input", "output"};
+        schema.fields = {"depth", "capacity"};
+        return schema;
+    }
+
+    void sample(double* values) override
+    {
+        values[0] = 1.;
+        values[1] = 8.;
+        values[2] = 2.;
+        values[3] = 16.;
+    }
+};
+
+// GPU monitor without labels, its GPUs are numbered
+class FakeGPUMonitor : public uprofile::IGPUMonitor
+{
+public:
+    void start(int) override { m_watching = true; }
+    void stop() override { m_watching = false; }
+    bool watching() const override { return m_watching; }
+    const std::vector<float>& getUsage() const override { return m_usages; }
+    void getMemory(std::vector<int>& usedMem, std::vector<int>& totalMem) const override
+    {
+        usedMem = {100, 200};
+        totalMem = {1000, 2000};
+    }
+
+private:
+    bool m_watching = false;
+    std::vector<float> m_usages = {10.f, 20.f};
+};
+
 TEST_CASE("Uprofile instant metrics", "[instant]")
 {
     uprofile::start(filename.c_str());
@@ -103,4 +209,1339 @@ TEST_CASE("Uprofile rotating files", "[rotation]")
     uprofile::stop();
     std::remove(file1.c_str());
     std::remove(file2.c_str());
-}
\ No newline at end of file
+}
+TEST_CASE("Uprofile rollups", "[rollup]")
+{
+    uprofile::enableRollups(false);
+    uprofile::start(filename.c_str());
+    uprofile::startCPUUsageMonitoring(100);
+
+    SECTION("Only aggregated metrics")
+    {
+        // Wait for several 1 s buckets to be complete
+        sleep(2);
+        uprofile::stop();
+
+        std::ifstream file(filename);
+        std::string line;
+        int nbSecondBuckets = 0;
+        while (std::getline(file, line)) {
+            REQUIRE(line.rfind("rollup;", 0) == 0);
+            if (line.find(";cpu;0;usage;1000;") != std::string::npos) {
+                nbSecondBuckets++;
+            }
+        }
+        REQUIRE(nbSecondBuckets >= 2);
+    }
+
+    uprofile::stop();
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Uprofile deadband", "[deadband]")
+{
+    uprofile::start(filename.c_str());
+    // Total memory never moves by 1 TiB so a single sample is expected
+    uprofile::setDeadband(uprofile::MonitorType::SYSTEM_MEMORY, 1024. * 1024. * 1024.);
+    uprofile::startSystemMemoryMonitoring(50);
+
+    SECTION("Samples recorded on change only")
+    {
+        sleep(1);
+        uprofile::stop();
+
+        std::ifstream file(filename);
+        std::string line;
+        int nbSamples = 0, nbDeadbands = 0;
+        while (std::getline(file, line)) {
+            if (line.rfind("sys_mem;", 0) == 0) {
+                nbSamples++;
+            } else if (line.rfind("deadband;", 0) == 0) {
+                nbDeadbands++;
+            }
+        }
+        REQUIRE(nbDeadbands == 1);
+        REQUIRE(nbSamples == 1);
+    }
+
+    uprofile::stop();
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Uprofile sinks", "[sinks]")
+{
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(4096);
+    std::atomic<size_t> nbRecords(0);
+    uprofile::CallbackSink* callbackSink = new uprofile::CallbackSink([&nbRecords](const char*, size_t, size_t count) {
+        nbRecords += count;
+    });
+    uprofile::addSink(memorySink, {"sys_mem"});
+    uprofile::addSink(callbackSink);
+    uprofile::start(nullptr);
+    uprofile::startCPUUsageMonitoring(50);
+    uprofile::startSystemMemoryMonitoring(50);
+
+    SECTION("Filtered and unfiltered sinks")
+    {
+        sleep(1);
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbLines = 0;
+        while (std::getline(content, line)) {
+            REQUIRE(line.rfind("sys_mem;", 0) == 0);
+            nbLines++;
+        }
+        REQUIRE(nbLines > 0);
+        REQUIRE(nbRecords > static_cast<size_t>(nbLines));
+    }
+
+    SECTION("Events dropped by a slow sink")
+    {
+        // The sink blocks its first batch so that the following events pile up
+        std::atomic<bool> released(false);
+        std::string lastRecords;
+        size_t nbDelivered = 0;
+        uprofile::CallbackSink* slowSink = new uprofile::CallbackSink([&](const char* records, size_t size, size_t count) {
+            while (!released) {
+                usleep(1000);
+            }
+            lastRecords.assign(records, size);
+            nbDelivered += count;
+        });
+        uprofile::addSink(slowSink, {"time_event"});
+        const size_t nbEvents = 500000; // more than the 8 MiB kept pending
+        for (size_t i = 0; i < nbEvents; ++i) {
+            uprofile::timeEnd("overflow");
+        }
+        released = true;
+        uprofile::removeSink(slowSink);
+
+        // The last batch ends with the number of events lost, whatever the filter of the sink
+        size_t pos = lastRecords.rfind("dropped;");
+        REQUIRE(pos != std::string::npos);
+        size_t nbDropped = std::stoul(lastRecords.substr(lastRecords.rfind(';') + 1));
+        REQUIRE(nbDropped > 0);
+        REQUIRE(nbDelivered - 1 + nbDropped == nbEvents);
+    }
+
+    SECTION("Socket sink with a peer not reading")
+    {
+        const std::string socketPath = "./test.sock";
+        unlink(socketPath.c_str());
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        REQUIRE(bind(server, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+        REQUIRE(listen(server, 16) == 0);
+
+        // Connections are never accepted: the socket buffers fill up and the sink must not block
+        uprofile::SocketSink socketSink(socketPath.c_str());
+        const std::string record = std::string(63, 'x') + "\n";
+        std::string batch;
+        for (int i = 0; i < 1024; ++i) {
+            batch += record;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < 20; ++i) {
+            socketSink.write(batch.data(), batch.size(), 1024);
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        REQUIRE(duration < 20 * uprofile::SocketSink::SEND_TIMEOUT);
+        REQUIRE(socketSink.droppedRecords() > 0);
+
+        close(server);
+        unlink(socketPath.c_str());
+    }
+
+    uprofile::stop();
+    uprofile::removeSink(memorySink);
+    uprofile::removeSink(callbackSink);
+}
+
+TEST_CASE("Uprofile independent profilers", "[profiler]")
+{
+    const std::string filename1 = "./test_1.log";
+    const std::string filename2 = "./test_2.log";
+    {
+        uprofile::Profiler profiler1, profiler2;
+        profiler1.start(filename1.c_str());
+        profiler2.start(filename2.c_str());
+        profiler2.setTimestampUnit(uprofile::TimestampUnit::UPTIME);
+
+        profiler1.timeBegin("task1");
+        profiler2.timeBegin("task2");
+        profiler1.timeEnd("task1");
+        profiler2.timeEnd("task2");
+
+        profiler1.stop();
+        profiler2.stop();
+    }
+
+    SECTION("Events saved to their own file")
+    {
+        std::ifstream file1(filename1), file2(filename2);
+        std::string content1((std::istreambuf_iterator<char>(file1)), std::istreambuf_iterator<char>());
+        std::string content2((std::istreambuf_iterator<char>(file2)), std::istreambuf_iterator<char>());
+        REQUIRE(content1.find("time_exec;") == 0);
+        REQUIRE(content1.find("task1") != std::string::npos);
+        REQUIRE(content1.find("task2") == std::string::npos);
+        REQUIRE(content2.find("task2") != std::string::npos);
+        REQUIRE(content2.find("task1") == std::string::npos);
+    }
+
+    std::remove(filename1.c_str());
+    std::remove(filename2.c_str());
+}
+
+TEST_CASE("Uprofile runtime activation", "[activation]")
+{
+    const unsigned long long networkCategory = 1ULL << 1;
+    const unsigned long long storageCategory = 1ULL << 2;
+
+    REQUIRE_FALSE(uprofile::isEnabled());
+    uprofile::start(filename.c_str());
+    REQUIRE(uprofile::isEnabled());
+
+    SECTION("Disabled profiling")
+    {
+        uprofile::setEnabled(false);
+        REQUIRE_FALSE(uprofile::isEnabled());
+        uprofile::timeBegin("disabled");
+        uprofile::timeEnd("disabled");
+        uprofile::setEnabled(true);
+        uprofile::timeBegin("enabled");
+        uprofile::timeEnd("enabled");
+        uprofile::stop();
+
+        std::ifstream file(filename);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.find("disabled") == std::string::npos);
+        REQUIRE(content.find("enabled") != std::string::npos);
+    }
+
+    SECTION("Category filtering")
+    {
+        uprofile::setCategories(networkCategory);
+        REQUIRE(uprofile::isEnabled(networkCategory));
+        REQUIRE_FALSE(uprofile::isEnabled(storageCategory));
+        uprofile::timeEnd("network_event", networkCategory);
+        uprofile::timeEnd("storage_event", storageCategory);
+        uprofile::setCategories(uprofile::ALL_CATEGORIES);
+        uprofile::stop();
+
+        std::ifstream file(filename);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.find("network_event") != std::string::npos);
+        REQUIRE(content.find("storage_event") == std::string::npos);
+    }
+
+    uprofile::stop();
+    REQUIRE_FALSE(uprofile::isEnabled());
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Uprofile counters", "[counters]")
+{
+    uprofile::start(filename.c_str());
+    uprofile::startCountersMonitoring(100);
+
+    SECTION("Counters aggregated from several threads")
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([]() {
+                for (int j = 0; j < 1000; ++j) {
+                    uprofile::counterAdd("requests");
+                    uprofile::histogramRecord("latency", 10.);
+                }
+                uprofile::gaugeSet("queue_depth", 3.);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        usleep(300000);
+        uprofile::stop();
+
+        std::ifstream file(filename);
+        std::string line, lastCounter, lastGauge;
+        long long nbLatencies = 0;
+        while (std::getline(file, line)) {
+            if (line.find("counter;") == 0 && line.find(";requests;") != std::string::npos) {
+                lastCounter = line;
+            } else if (line.find("gauge;") == 0) {
+                lastGauge = line;
+            } else if (line.find("histogram;") == 0 && line.find(";latency;") != std::string::npos) {
+                // Format is histogram;<timestamp>;<name>;<count>;...
+                std::string count = line.substr(line.find(";latency;") + 9);
+                nbLatencies += std::stoll(count.substr(0, count.find(';')));
+            }
+        }
+        REQUIRE(lastCounter.find(";requests;4000;") != std::string::npos);
+        REQUIRE(lastGauge.find(";queue_depth;3") != std::string::npos);
+        REQUIRE(nbLatencies == 4000);
+    }
+
+    uprofile::stop();
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Uprofile custom monitors", "[monitors]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(8192);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.addMonitor(new QueueMonitor, 50);
+    profiler.startSystemMemoryMonitoring(50);
+
+    SECTION("Samples written with the declared schema")
+    {
+        usleep(300000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbSchemas = 0, nbInputs = 0, nbOutputs = 0, nbSysMems = 0;
+        while (std::getline(content, line)) {
+            if (line.rfind("schema;", 0) == 0) {
+                REQUIRE(line.find(";queue;1;depth;capacity") != std::string::npos);
+                nbSchemas++;
+            } else if (line.rfind("queue;", 0) == 0) {
+                if (line.find(";input;1;8") != std::string::npos) {
+                    nbInputs++;
+                } else {
+                    REQUIRE(line.find(";output;2;16") != std::string::npos);
+                    nbOutputs++;
+                }
+            } else if (line.rfind("sys_mem;", 0) == 0) {
+                nbSysMems++;
+            }
+        }
+        REQUIRE(nbSchemas == 1);
+        REQUIRE(nbInputs > 0);
+        REQUIRE(nbInputs == nbOutputs);
+        REQUIRE(nbSysMems > 0);
+    }
+
+    SECTION("Values not holding in an integer")
+    {
+        class ExtremeMonitor : public uprofile::IMetricMonitor
+        {
+        public:
+            uprofile::MetricSchema schema() const override
+            {
+                uprofile::MetricSchema schema;
+                schema.name = "extreme";
+                schema.fields = {"nan", "inf", "huge", "integer"};
+                return schema;
+            }
+
+            void sample(double* values) override
+            {
+                values[0] = std::nan("");
+                values[1] = -INFINITY;
+                values[2] = 1e20;
+                values[3] = 42.;
+            }
+        };
+        profiler.addMonitor(new ExtremeMonitor, 50);
+        usleep(200000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbSamples = 0;
+        while (std::getline(content, line)) {
+            if (line.rfind("extreme;", 0) == 0) {
+                REQUIRE(line.substr(line.find(';', 8)) == ";nan;-inf;100000000000000000000.000000;42");
+                nbSamples++;
+            }
+        }
+        REQUIRE(nbSamples > 0);
+    }
+
+    SECTION("Monitoring started concurrently")
+    {
+        // Each round starts the scheduler thread again from several threads at the same time
+        for (int round = 0; round < 100; ++round) {
+            profiler.stop();
+            profiler.start(nullptr);
+            std::atomic<bool> go(false);
+            std::vector<std::function<void()>> starts = {
+                [&]() { profiler.addMonitor(new QueueMonitor, 10); },
+                [&]() { profiler.startCountersMonitoring(10); },
+                [&]() { profiler.startLockMonitoring(10); },
+                [&]() { profiler.startFrameMonitoring(10); },
+                [&]() { profiler.startSelfMonitoring(10); }};
+            std::vector<std::thread> threads;
+            for (auto& start : starts) {
+                threads.emplace_back([&]() {
+                    while (!go) {
+                    }
+                    start();
+                });
+            }
+            go = true;
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        usleep(100000);
+        profiler.stop();
+        REQUIRE(memorySink->content().find("queue;") != std::string::npos);
+    }
+}
+
+TEST_CASE("Uprofile I/O monitoring", "[io]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(16384);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startProcessIOMonitoring(50);
+    profiler.startNetworkIOMonitoring(50);
+
+    SECTION("I/O rates of the process and of the network interfaces")
+    {
+        // Generate some process I/O
+        for (int i = 0; i < 10; ++i) {
+            std::ofstream(filename) << std::string(4096, 'x');
+            usleep(30000);
+        }
+        profiler.stop();
+        std::remove(filename.c_str());
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        double written = 0.;
+        int nbNetRecords = 0;
+        while (std::getline(content, line)) {
+            if (line.rfind("proc_io;", 0) == 0) {
+                // Format is proc_io;<timestamp>;<read_kb_s>;<write_kb_s>;<rchar_kb_s>;<wchar_kb_s>;<syscr_s>;<syscw_s>
+                std::istringstream fields(line);
+                std::string field;
+                for (int i = 0; i < 6 && std::getline(fields, field, ';'); ++i) {
+                }
+                written += std::stod(field);
+            } else if (line.rfind("net_io;", 0) == 0) {
+                REQUIRE(std::count(line.begin(), line.end(), ';') == 8);
+                nbNetRecords++;
+            }
+        }
+        REQUIRE(written > 0.);
+        REQUIRE(nbNetRecords > 0);
+    }
+}
+
+TEST_CASE("Uprofile container monitoring", "[cgroup]")
+{
+    // Fake cgroup v2 and pressure directories
+    const std::string root = "./fake_cgroup";
+    FakeTree tree(root);
+    tree.writeFile("/cpu.stat", "usage_usec 2377373\nuser_usec 1618163\nsystem_usec 759209\n"
+                                "nr_periods 1000\nnr_throttled 12\nthrottled_usec 42000\n");
+    tree.writeFile("/memory.current", "1048576\n");
+    tree.writeFile("/memory.max", "max\n");
+    tree.writeFile("/memory.stat", "anon 524288\nfile 262144\nkernel 0\n");
+    tree.writeFile("/cpu.pressure", "some avg10=1.50 avg60=0.25 avg300=0.05 total=123456\n"
+                                    "full avg10=0.75 avg60=0.00 avg300=0.00 total=4567\n");
+
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(8192);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.addMonitor(new uprofile::CgroupMonitor(root), 50);
+    profiler.addMonitor(new uprofile::PressureMonitor(root), 50);
+
+    SECTION("cgroup limits and pressure stall information")
+    {
+        usleep(200000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line, lastCgroup, lastPressure;
+        while (std::getline(content, line)) {
+            if (line.rfind("cgroup;", 0) == 0) {
+                lastCgroup = line;
+            } else if (line.rfind("psi;", 0) == 0) {
+                lastPressure = line;
+            }
+        }
+        // No CPU used between samples, memory in KiB and no memory limit
+        REQUIRE(lastCgroup.find(";0;0;0;1024;0;512;256") != std::string::npos);
+        REQUIRE(lastPressure.find(";cpu;1.500000;0.250000;0.050000;0.750000;0;0") != std::string::npos);
+    }
+}
+
+TEST_CASE("Uprofile synthetic system root", "[sysroot]")
+{
+    // Fake procfs and sysfs with 12 CPUs
+    const std::string root = "./fake_sysroot";
+    FakeTree tree(root);
+    tree.writeFile("/sys/devices/system/cpu/present", "0-11\n");
+    tree.writeFile("/proc/meminfo", "MemTotal: 1000 kB\nMemFree: 200 kB\nMemAvailable: 600 kB\n");
+    tree.writeFile("/proc/stat", "");
+    // Each step adds 100 ticks to the times of the online CPUs
+    std::vector<int> busy(12, 0), idle(12, 0);
+    auto writeStat = [&](std::function<int(int)> load, const std::vector<int>& offline) {
+        std::ostringstream stat;
+        stat << "cpu  0 0 0 0 0 0 0\n";
+        for (int cpu = 0; cpu < 12; ++cpu) {
+            if (std::find(offline.begin(), offline.end(), cpu) == offline.end()) {
+                busy[cpu] += load(cpu);
+                idle[cpu] += 100 - load(cpu);
+                stat << "cpu" << cpu << " " << busy[cpu] << " 0 0 " << idle[cpu] << " 0 0 0\n";
+            }
+        }
+        stat << "intr 0\nctxt 0\n";
+        // Rewritten in a single write so that the monitor never reads a truncated file
+        int fd = open((root + "/proc/stat").c_str(), O_WRONLY);
+        REQUIRE(pwrite(fd, stat.str().c_str(), stat.str().size(), 0) == static_cast<ssize_t>(stat.str().size()));
+        REQUIRE(ftruncate(fd, stat.str().size()) == 0);
+        close(fd);
+    };
+    auto ramp = [](int cpu) { return 5 * cpu; };
+    auto half = [](int) { return 50; };
+    writeStat(ramp, {});
+
+    SystemRootGuard rootGuard(root + "/");
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(65536);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startCPUUsageMonitoring(50);
+
+    SECTION("System memory")
+    {
+        int total = 0, available = 0, free = 0;
+        uprofile::getSystemMemory(total, available, free);
+        REQUIRE(total == 1000);
+        REQUIRE(available == 600);
+        REQUIRE(free == 200);
+    }
+
+    SECTION("CPU usage with 'cpu1' offline then back online")
+    {
+        usleep(150000);
+        writeStat(ramp, {1});
+        usleep(150000);
+        writeStat(half, {});
+        usleep(150000);
+        profiler.stop();
+
+        // Format is cpu;<timestamp>;<cpu>;<usage>, one record per CPU and sample. Records of
+        // a sample may not share the same timestamp: a sample starts at the record of 'cpu0'
+        std::vector<std::map<int, double>> samples;
+        std::istringstream content(memorySink->content());
+        std::string line;
+        while (std::getline(content, line)) {
+            if (line.rfind("cpu;", 0) == 0) {
+                std::istringstream fields(line.substr(4));
+                std::string timestamp, cpu, usage;
+                std::getline(fields, timestamp, ';');
+                std::getline(fields, cpu, ';');
+                std::getline(fields, usage, ';');
+                if (std::stoi(cpu) == 0) {
+                    samples.push_back(std::map<int, double>());
+                }
+                if (!samples.empty()) {
+                    samples.back()[std::stoi(cpu)] = std::stod(usage);
+                }
+            }
+        }
+        bool offlineSample = false, onlineSample = false;
+        for (auto it = samples.cbegin(); it != samples.cend(); ++it) {
+            std::map<int, double> usages = *it;
+            // 'cpu1' offline: it must not be read from the 'cpu10' line
+            if (usages[1] == 0. && usages[10] > 49. && usages[10] < 51.) {
+                offlineSample = true;
+                REQUIRE(usages[2] > 9.);
+                REQUIRE(usages[2] < 11.);
+                REQUIRE(usages[11] > 54.);
+                REQUIRE(usages[11] < 56.);
+            }
+            // 'cpu1' back online: its usage is computed from its times before going offline
+            if (usages[1] > 49. && usages[1] < 51.) {
+                onlineSample = true;
+            }
+        }
+        REQUIRE(offlineSample);
+        REQUIRE(onlineSample);
+    }
+
+    profiler.stop();
+}
+
+TEST_CASE("Uprofile CPU frequency and NUMA monitoring", "[numa]")
+{
+    // Fake sysfs of 4 CPUs: 2 packages of 1 core with 2 SMT siblings, one NUMA node per package
+    const std::string root = "./fake_numa";
+    FakeTree tree(root);
+    tree.writeFile("/sys/devices/system/cpu/present", "0-3\n");
+    tree.writeFile("/sys/devices/system/node/online", "0-1\n");
+    for (int cpu = 0; cpu < 4; ++cpu) {
+        std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        tree.writeFile(dir + "/topology/physical_package_id", std::to_string(cpu / 2) + "\n");
+        tree.writeFile(dir + "/topology/core_id", "0\n");
+        tree.writeFile(dir + "/topology/thread_siblings_list", cpu < 2 ? "0-1\n" : "2-3\n");
+        tree.writeFile(dir + "/cpufreq/scaling_cur_freq", std::to_string(1200000 + cpu * 100000) + "\n");
+        tree.writeFile(dir + "/cpufreq/scaling_max_freq", "3000000\n");
+    }
+    for (int node = 0; node < 2; ++node) {
+        std::string prefix = "Node " + std::to_string(node) + " ";
+        tree.writeFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", node == 0 ? "0-1\n" : "2-3\n");
+        tree.writeFile("/sys/devices/system/node/node" + std::to_string(node) + "/meminfo",
+                       prefix + "MemTotal:       1000 kB\n" + prefix + "MemFree:         " + std::to_string(100 * (node + 1)) + " kB\n" +
+                           prefix + "MemUsed:         " + std::to_string(1000 - 100 * (node + 1)) + " kB\n" +
+                           prefix + "Active:          50 kB\n" + prefix + "FilePages:       30 kB\n" + prefix + "AnonPages:       20 kB\n");
+    }
+    tree.writeFile("/proc/self/numa_maps",
+                   "7f0000000000 default anon=3 dirty=3 N0=2 N1=1 kernelpagesize_kB=4\n"
+                   "7f0000100000 default file=/usr/lib/libc.so.6 mapped=10 N0=10 kernelpagesize_kB=4\n"
+                   "7f0000200000 default file=/dev/hugepages/buffer huge N1=1 kernelpagesize_kB=2048\n");
+
+    SystemRootGuard rootGuard(root);
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(65536);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startCPUFrequencyMonitoring(50);
+    profiler.startNumaMonitoring(50);
+
+    SECTION("Topology, frequencies and memory of the nodes")
+    {
+        usleep(200000);
+        profiler.stop();
+
+        std::string content = memorySink->content();
+        // topology;<timestamp>;<cpu>;<package>;<core>;<node>;<siblings>, written once
+        REQUIRE(content.find(";2;1;0;1;2-3\n") != std::string::npos);
+        size_t nbTopologyRecords = 0;
+        for (size_t pos = content.find("topology;"); pos != std::string::npos; pos = content.find("topology;", pos + 1)) {
+            nbTopologyRecords++;
+        }
+        REQUIRE(nbTopologyRecords == 4);
+        // cpu_freq;<timestamp>;<cpu>;<mhz>;<max_mhz>
+        REQUIRE(content.find(";3;1500;3000\n") != std::string::npos);
+        // numa_mem;<timestamp>;<node>;<total>;<free>;<used>;<file>;<anon>
+        REQUIRE(content.find(";1;1000;200;800;30;20\n") != std::string::npos);
+        // proc_numa;<timestamp>;<node>;<total>;<anon>;<file>
+        REQUIRE(content.find(";0;48;8;40\n") != std::string::npos);
+        REQUIRE(content.find(";1;2052;4;2048\n") != std::string::npos);
+    }
+
+    profiler.stop();
+}
+
+TEST_CASE("Uprofile DRM GPU monitoring", "[gpu]")
+{
+    // Fake /sys/class/drm: 'card0' exposes all the metrics, 'card2' only its usage and 'card1' none
+    const std::string root = "./fake_drm";
+    FakeTree tree(root);
+    tree.writeFile("/sys/class/drm/card0/device/gpu_busy_percent", "42\n");
+    tree.writeFile("/sys/class/drm/card0/device/mem_info_vram_used", "1073741824\n");
+    tree.writeFile("/sys/class/drm/card0/device/mem_info_vram_total", "8589934592\n");
+    tree.writeFile("/sys/class/drm/card0-HDMI-A-1/device/gpu_busy_percent", "99\n");
+    tree.writeFile("/sys/class/drm/card1/device/vendor", "0x8086\n");
+    tree.writeFile("/sys/class/drm/card2/device/gpu_busy_percent", "7\n");
+    tree.writeFile("/sys/class/drm/renderD128/device/gpu_busy_percent", "99\n");
+
+    SystemRootGuard rootGuard(root);
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(65536);
+    profiler.addSink(memorySink);
+    profiler.addGPUMonitor(new uprofile::DrmMonitor);
+    profiler.addGPUMonitor(new FakeGPUMonitor);
+    profiler.start(nullptr);
+    profiler.startGPUUsageMonitoring(50);
+    profiler.startGPUMemoryMonitoring(50);
+
+    SECTION("Usage and memory of the GPUs of several monitors")
+    {
+        usleep(100000);
+        // Files are kept opened and read again at each dump
+        tree.writeFile("/sys/class/drm/card0/device/gpu_busy_percent", "43\n");
+        usleep(150000);
+        profiler.stop();
+
+        std::string content = memorySink->content();
+        // gpu;<timestamp>;<gpu>;<usage>
+        REQUIRE(content.find(";card0;42.000000\n") != std::string::npos);
+        REQUIRE(content.find(";card0;43.000000\n") != std::string::npos);
+        REQUIRE(content.find(";card2;7.000000\n") != std::string::npos);
+        REQUIRE(content.find(";card1;") == std::string::npos);
+        REQUIRE(content.find(";99.000000\n") == std::string::npos);
+        // GPUs of the monitor without labels are numbered after the previous ones
+        REQUIRE(content.find(";2;10.000000\n") != std::string::npos);
+        REQUIRE(content.find(";3;20.000000\n") != std::string::npos);
+        // gpu_mem;<timestamp>;<gpu>;<used>;<total> (in KiB)
+        REQUIRE(content.find(";card0;1048576;8388608\n") != std::string::npos);
+        REQUIRE(content.find(";card2;0;0\n") != std::string::npos);
+        REQUIRE(content.find(";3;200;2000\n") != std::string::npos);
+    }
+
+    profiler.stop();
+    profiler.removeGPUMonitor();
+}
+
+#if defined(GPU_MONITOR_NVIDIA)
+TEST_CASE("Uprofile nvidia-smi monitoring", "[gpu]")
+{
+    // Stand-in of nvidia-smi dumping the metrics of 2 GPUs, its first run hangs after one dump
+    const std::string script = "./fake-nvidia-smi";
+    const std::string runs = "./fake-nvidia-smi.runs";
+    std::ofstream(script) << "#!/bin/sh\n"
+                          << "if [ \"$1\" = \"--query-gpu=count\" ]; then echo 2; echo 2; exit 0; fi\n"
+                          << "echo run >> " << runs << "\n"
+                          << "echo '0, 35, 1024, 8192'\n"
+                          << "echo '1, [N/A], 512, 4096'\n"
+                          << "if [ $(wc -l < " << runs << ") -eq 1 ]; then exec sleep 1000; fi\n"
+                          << "while true; do echo '0, 60, 2048, 8192'; echo '1, 5, 512, 4096'; sleep 0.05; done\n";
+    chmod(script.c_str(), 0755);
+
+    uprofile::NvidiaMonitor monitor(script);
+    monitor.start(50);
+    auto waitUsage = [&](float usage, int timeout) {
+        for (int waited = 0; waited < timeout && monitor.getUsage()[0] != usage; waited += 10) {
+            usleep(10000);
+        }
+        return monitor.getUsage()[0] == usage;
+    };
+
+    SECTION("Restart of a hung nvidia-smi and stop")
+    {
+        REQUIRE(monitor.getUsage().size() == 2);
+        REQUIRE(waitUsage(35.f, 1000));
+        REQUIRE(monitor.getUsage()[1] == 0.f); // '[N/A]'
+
+        // No output during 10 periods (1 s at least): nvidia-smi is killed and started again
+        REQUIRE(waitUsage(60.f, 3000));
+        REQUIRE(monitor.watching());
+        std::vector<int> usedMems, totalMems;
+        monitor.getMemory(usedMems, totalMems);
+        REQUIRE(usedMems[0] == 2048 * 1024);
+        REQUIRE(totalMems[0] == 8192 * 1024);
+        REQUIRE(usedMems[1] == 512 * 1024);
+        REQUIRE(monitor.getUsage()[1] == 5.f);
+
+        auto begin = std::chrono::steady_clock::now();
+        monitor.stop();
+        REQUIRE(std::chrono::steady_clock::now() - begin < std::chrono::seconds(1));
+        REQUIRE_FALSE(monitor.watching());
+        // nvidia-smi has been reaped
+        REQUIRE(waitpid(-1, nullptr, WNOHANG) == -1);
+    }
+
+    monitor.stop();
+    std::remove(script.c_str());
+    std::remove(runs.c_str());
+}
+#endif
+
+TEST_CASE("Uprofile thread monitoring", "[threads]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(8192);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startThreadCPUMonitoring(100, 1);
+
+    SECTION("Most consuming thread")
+    {
+        std::atomic<bool> running(true);
+        std::thread busy([&running]() {
+            pthread_setname_np(pthread_self(), "busy_worker");
+            while (running) {
+            }
+        });
+        usleep(500000);
+        profiler.stop();
+        running = false;
+        busy.join();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbRecords = 0, nbBusy = 0;
+        while (std::getline(content, line)) {
+            // Format is thread;<timestamp>;<tid>;<name>;<usage>;<cpu>;<state>
+            REQUIRE(line.rfind("thread;", 0) == 0);
+            nbRecords++;
+            if (line.find(";busy_worker;") != std::string::npos) {
+                nbBusy++;
+            }
+        }
+        REQUIRE(nbRecords > 1);
+        // Top thread of each period (except the first one where no usage is known yet)
+        REQUIRE(nbBusy >= nbRecords - 1);
+    }
+}
+
+TEST_CASE("Uprofile processes monitoring", "[processes]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(16384);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+
+    SECTION("Process tree with an exiting child")
+    {
+        pid_t child = fork();
+        if (child == 0) {
+            usleep(300000);
+            _exit(0);
+        }
+        profiler.startProcessTreeMonitoring(50);
+        usleep(200000);
+        waitpid(child, nullptr, 0);
+        usleep(200000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line, lastLine;
+        int nbSelf = 0, nbChild = 0;
+        while (std::getline(content, line)) {
+            // Format is process;<timestamp>;<pid>;<name>;<usage>;<rss>;<pss>;<threads>
+            REQUIRE(line.rfind("process;", 0) == 0);
+            std::istringstream fields(line);
+            std::string field, pid;
+            std::getline(fields, field, ';');
+            std::getline(fields, field, ';');
+            std::getline(fields, pid, ';');
+            if (std::stoi(pid) == getpid()) {
+                nbSelf++;
+                lastLine = line;
+            } else if (std::stoi(pid) == child) {
+                nbChild++;
+            }
+        }
+        REQUIRE(nbSelf > 4);
+        REQUIRE(nbChild > 0);
+        // Child stopped being monitored once exited
+        REQUIRE(nbChild < nbSelf);
+        REQUIRE(lastLine.find(";uprof-tests;") != std::string::npos);
+    }
+}
+
+TEST_CASE("Uprofile shared memory collection", "[sharedmemory]")
+{
+    const std::string segment = "/uprof-tests-" + std::to_string(getpid());
+    uprofile::SharedMemoryCollector collector(segment.c_str(), filename.c_str());
+    REQUIRE(collector.start());
+
+    SECTION("Events of several processes in a single file")
+    {
+        pid_t child = fork();
+        if (child == 0) {
+            uprofile::Profiler profiler;
+            profiler.addSink(new uprofile::SharedMemorySink(segment.c_str()));
+            profiler.start(nullptr);
+            profiler.timeBegin("child_task");
+            profiler.timeEnd("child_task");
+            profiler.stop();
+            _exit(0);
+        }
+
+        uprofile::Profiler profiler;
+        profiler.addSink(new uprofile::SharedMemorySink(segment.c_str()));
+        profiler.start(nullptr);
+        profiler.timeBegin("parent_task");
+        profiler.timeEnd("parent_task");
+        waitpid(child, nullptr, 0);
+        profiler.stop();
+        collector.stop();
+
+        std::ifstream file(filename);
+        std::string line;
+        std::getline(file, line);
+        REQUIRE(line.find("collector;") == 0);
+        int nbParent = 0, nbChild = 0;
+        unsigned long long lastTimestamp = 0;
+        while (std::getline(file, line)) {
+            // Format is time_exec;<end timestamp>;<pid>;<start timestamp>;<task>
+            std::istringstream fields(line);
+            std::string type, timestamp, pid, task;
+            std::getline(fields, type, ';');
+            std::getline(fields, timestamp, ';');
+            std::getline(fields, pid, ';');
+            std::getline(fields, task, ';');
+            std::getline(fields, task, ';');
+            REQUIRE(type == "time_exec");
+            // Records are ordered by timestamp
+            REQUIRE(std::stoull(timestamp) >= lastTimestamp);
+            lastTimestamp = std::stoull(timestamp);
+            if (std::stoi(pid) == getpid() && task == "parent_task") {
+                nbParent++;
+            } else if (std::stoi(pid) == child && task == "child_task") {
+                nbChild++;
+            }
+        }
+        REQUIRE(nbParent == 1);
+        REQUIRE(nbChild == 1);
+    }
+
+    collector.stop();
+    uprofile::SharedMemoryCollector::removeSegment(segment.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Uprofile flight recorder", "[recorder]")
+{
+    const std::string dumpPath = "./test_flight.log";
+    const std::string dump0 = "./test_flight_0.log";
+    const std::string dump1 = "./test_flight_1.log";
+    uprofile::Profiler profiler;
+    profiler.enableFlightRecorder(dumpPath.c_str(), 1024);
+    profiler.start(nullptr);
+
+    SECTION("Dump of the most recent whole records")
+    {
+        for (int i = 0; i < 100; ++i) {
+            profiler.timeBegin("task_" + std::to_string(i));
+            profiler.timeEnd("task_" + std::to_string(i));
+        }
+        REQUIRE(profiler.dumpFlightRecorder());
+        std::ifstream file(dump0);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.size() <= 1024);
+        REQUIRE(content.find("time_exec;") == 0);
+        REQUIRE(content.find(";task_99\n") != std::string::npos);
+        REQUIRE(content.find(";task_0\n") == std::string::npos);
+    }
+
+    SECTION("Dump triggered by a slow span")
+    {
+        profiler.setFlightRecorderLatencyTrigger(50);
+        profiler.timeBegin("fast");
+        profiler.timeEnd("fast");
+        REQUIRE_FALSE(fileExists(dump0));
+        profiler.timeBegin("slow");
+        usleep(60000);
+        profiler.timeEnd("slow");
+        // The dump is written by the scheduler thread
+        for (int waited = 0; waited < 1000 && !fileExists(dump0); waited += 10) {
+            usleep(10000);
+        }
+        std::ifstream file(dump0);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.find(";fast\n") != std::string::npos);
+        REQUIRE(content.find(";slow\n") != std::string::npos);
+    }
+
+    SECTION("Dump on crash")
+    {
+        pid_t child = fork();
+        if (child == 0) {
+            uprofile::enableFlightRecorderCrashDump();
+            profiler.timeBegin("before_crash");
+            profiler.timeEnd("before_crash");
+            abort();
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        REQUIRE(WIFSIGNALED(status));
+        REQUIRE(WTERMSIG(status) == SIGABRT);
+        std::ifstream file(dump0);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.find(";before_crash\n") != std::string::npos);
+    }
+
+    profiler.stop();
+    std::remove(dump0.c_str());
+    std::remove(dump1.c_str());
+}
+
+TEST_CASE("Uprofile adaptive monitoring", "[adaptive]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(16384);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+
+    SECTION("Fast period while a slow span is detected")
+    {
+        uprofile::AdaptiveRule rule;
+        rule.name = "slow_span";
+        rule.metric = "time_exec";
+        rule.field = "slow";
+        rule.threshold = 50;
+        rule.monitors = {uprofile::MonitorType::PROCESS_MEMORY};
+        rule.fastPeriod = 20;
+        rule.window = 300;
+        profiler.addAdaptiveRule(rule);
+        profiler.startProcessMemoryMonitoring(1000);
+
+        profiler.timeBegin("slow");
+        usleep(60000);
+        profiler.timeEnd("slow");
+        usleep(600000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int state = 0, nbFastSamples = 0;
+        while (std::getline(content, line)) {
+            if (line.rfind("period;", 0) == 0) {
+                // Format is period;<timestamp>;<monitor>;<period>;<rule>
+                if (state == 0) {
+                    REQUIRE(line.find(";proc_mem;20;slow_span") != std::string::npos);
+                } else {
+                    REQUIRE(line.find(";proc_mem;1000;") != std::string::npos);
+                }
+                state++;
+            } else if (line.rfind("proc_mem;", 0) == 0 && state == 1) {
+                nbFastSamples++;
+            }
+        }
+        // Back to the base period once the window has elapsed
+        REQUIRE(state == 2);
+        REQUIRE(nbFastSamples > 5);
+    }
+}
+
+static std::atomic<unsigned long long> g_burnResult(0);
+
+void burnCpu(int duration)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration);
+    unsigned long long result = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 10000; ++i) {
+            result += i * i;
+        }
+    }
+    g_burnResult += result;
+}
+
+TEST_CASE("Uprofile stack sampling", "[sampling]")
+{
+    const std::string foldedPath = "./test.folded";
+    uprofile::start(nullptr);
+
+    SECTION("Folded stacks of a span")
+    {
+        uprofile::startStackSampling(foldedPath.c_str(), 100, 64);
+        uprofile::timeBegin("busy");
+        burnCpu(300);
+        uprofile::timeEnd("busy");
+        uprofile::stopStackSampling();
+
+        std::ifstream file(foldedPath);
+        std::string line;
+        unsigned long long nbSamples = 0, nbBusySamples = 0;
+        while (std::getline(file, line)) {
+            // Format is 'frame1;frame2;... <count>'
+            size_t separator = line.rfind(' ');
+            REQUIRE(separator != std::string::npos);
+            unsigned long long count = std::stoull(line.substr(separator + 1));
+            nbSamples += count;
+            if (line.find("[busy];") == 0 && line.find(";burnCpu(int)") != std::string::npos) {
+                nbBusySamples += count;
+            }
+        }
+        // About 30 samples for 300 ms of CPU time
+        REQUIRE(nbSamples > 10);
+        REQUIRE(nbBusySamples > nbSamples / 2);
+    }
+
+    SECTION("Span ended in another thread")
+    {
+        uprofile::startStackSampling(foldedPath.c_str(), 100, 64);
+        uprofile::timeBegin("moved");
+        std::thread([]() { uprofile::timeEnd("moved"); }).join();
+        burnCpu(300);
+        uprofile::stopStackSampling();
+
+        std::ifstream file(foldedPath);
+        std::string line;
+        unsigned long long nbSamples = 0;
+        while (std::getline(file, line)) {
+            nbSamples++;
+            REQUIRE(line.find("[moved]") == std::string::npos);
+        }
+        REQUIRE(nbSamples > 0);
+    }
+
+    uprofile::stop();
+    std::remove(foldedPath.c_str());
+}
+
+#if defined(FUNCTION_INSTRUMENTATION_ON)
+// Hooks called by code compiled with -finstrument-functions
+extern "C" void __cyg_profile_func_enter(void* function, void* callSite);
+extern "C" void __cyg_profile_func_exit(void* function, void* callSite);
+
+void instrumentedCall(int duration)
+{
+    __cyg_profile_func_enter(reinterpret_cast<void*>(&instrumentedCall), nullptr);
+    usleep(duration * 1000);
+    __cyg_profile_func_exit(reinterpret_cast<void*>(&instrumentedCall), nullptr);
+}
+
+TEST_CASE("Uprofile function instrumentation", "[instrumentation]")
+{
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(8192);
+    uprofile::start(nullptr);
+    uprofile::addSink(memorySink);
+
+    auto countCalls = [&]() {
+        usleep(300000); // events are flushed to the sinks every 100 ms
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbCalls = 0;
+        while (std::getline(content, line)) {
+            // Format is 'func;end;start;location;duration;tid'
+            if (line.rfind("func;", 0) == 0) {
+                REQUIRE(line.find("+0x") != std::string::npos);
+                nbCalls++;
+            }
+        }
+        return nbCalls;
+    };
+
+    SECTION("Only slow calls are recorded")
+    {
+        uprofile::startFunctionInstrumentation(10000);
+        instrumentedCall(0);
+        instrumentedCall(20);
+        uprofile::stopFunctionInstrumentation();
+        instrumentedCall(20);
+        REQUIRE(countCalls() == 1);
+    }
+
+    SECTION("Filtered out functions are not recorded")
+    {
+        uprofile::startFunctionInstrumentation(0);
+        uprofile::setFunctionFilters({}, {"instrumentedCall"});
+        instrumentedCall(1);
+        uprofile::setFunctionFilters({"instrumentedCall"});
+        instrumentedCall(1);
+        uprofile::setFunctionFilters({});
+        REQUIRE(countCalls() == 1);
+    }
+
+    uprofile::stop();
+}
+#endif
+
+TEST_CASE("Uprofile lock contention", "[locks]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(16384);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startLockMonitoring(50);
+
+    SECTION("Wait and hold times of contended locks")
+    {
+        uprofile::ProfiledMutex mutex("queue");
+        uprofile::ProfiledSharedMutex sharedMutex("cache");
+        uprofile::ProfiledConditionVariable condition("ready");
+        bool ready = false;
+
+        std::thread holder([&]() {
+            std::lock_guard<uprofile::ProfiledMutex> guard(mutex);
+            sharedMutex.lock();
+            usleep(100000);
+            sharedMutex.unlock();
+        });
+        usleep(20000);
+        // Contended acquisitions have their hold time measured
+        mutex.lock();
+        usleep(60000);
+        mutex.unlock();
+        sharedMutex.lock_shared();
+        sharedMutex.unlock_shared();
+        holder.join();
+
+        std::thread notifier([&]() {
+            usleep(20000);
+            std::lock_guard<uprofile::ProfiledMutex> guard(mutex);
+            ready = true;
+            condition.notify_all();
+        });
+        {
+            std::unique_lock<uprofile::ProfiledMutex> lock(mutex);
+            condition.wait(lock, [&]() { return ready; });
+            REQUIRE_FALSE(condition.wait_for(lock, std::chrono::milliseconds(10), []() { return false; }));
+        }
+        notifier.join();
+        usleep(300000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        std::map<std::string, std::vector<double>> locks;
+        while (std::getline(content, line)) {
+            // Format is 'lock;timestamp;name;acquisitions;contended;wait_p50;wait_p99;wait_max;hold_p50;hold_p99;hold_max'
+            if (line.rfind("lock;", 0) == 0) {
+                std::vector<std::string> fields;
+                std::istringstream record(line);
+                std::string field;
+                while (std::getline(record, field, ';')) {
+                    fields.push_back(field);
+                }
+                REQUIRE(fields.size() == 11);
+                // Counts are per period and summed, times are the highest of all periods
+                std::vector<double>& values = locks[fields[2]];
+                values.resize(8);
+                for (size_t i = 0; i < 8; ++i) {
+                    double value = std::stod(fields[i + 3]);
+                    values[i] = i < 2 ? values[i] + value : std::max(values[i], value);
+                }
+            }
+        }
+        REQUIRE(locks.count("queue") == 1);
+        REQUIRE(locks["queue"][1] >= 1);       // the main thread waited for the holder
+        REQUIRE(locks["queue"][4] >= 50000);   // wait_max (us)
+        REQUIRE(locks["queue"][7] >= 50000);   // hold_max (us)
+        REQUIRE(locks.count("cache") == 1);
+        REQUIRE(locks["ready"][0] >= 2);       // waits
+        REQUIRE(locks["ready"][1] == 1);       // timed out wait
+        REQUIRE(locks["ready"][4] >= 10000);   // wait_max (us)
+    }
+}
+
+TEST_CASE("Uprofile frame pacing", "[frames]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(65536);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startFrameMonitoring(100, true);
+
+    SECTION("Rate, frame times and missed deadlines")
+    {
+        uprofile::setFrameRate("video", 100.);
+        for (int i = 0; i < 30; ++i) {
+            usleep(i == 15 ? 50000 : 10000);
+            uprofile::markFrame("video");
+        }
+        usleep(300000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbRawFrames = 0;
+        unsigned long long nbFrames = 0, nbMissed = 0;
+        double maxFrameTime = 0.;
+        while (std::getline(content, line)) {
+            std::vector<std::string> fields;
+            std::istringstream record(line);
+            std::string field;
+            while (std::getline(record, field, ';')) {
+                fields.push_back(field);
+            }
+            if (fields[0] == "frame") {
+                // Format is 'frame;timestamp;channel;fps;frames;avg;p50;p99;max;jitter;missed'
+                REQUIRE(fields.size() == 11);
+                REQUIRE(fields[2] == "video");
+                REQUIRE(std::stod(fields[3]) > 0.);
+                nbFrames += std::stoull(fields[4]);
+                maxFrameTime = std::max(maxFrameTime, std::stod(fields[8]));
+                nbMissed += std::stoull(fields[10]);
+            } else if (fields[0] == "frame_time") {
+                // Format is 'frame_time;timestamp;channel;frame_time'
+                REQUIRE(fields.size() == 4);
+                nbRawFrames++;
+            }
+        }
+        // The first mark only starts the channel
+        REQUIRE(nbFrames == 29);
+        REQUIRE(nbRawFrames == 29);
+        REQUIRE(maxFrameTime >= 50.);
+        REQUIRE(nbMissed >= 3);
+    }
+}
+
+TEST_CASE("Uprofile self monitoring", "[self]")
+{
+    uprofile::Profiler profiler;
+    uprofile::MemorySink* memorySink = new uprofile::MemorySink(65536);
+    profiler.addSink(memorySink);
+    profiler.start(nullptr);
+    profiler.startSelfMonitoring(50);
+
+    SECTION("Overhead of the profiler")
+    {
+        for (int i = 0; i < 1000; ++i) {
+            profiler.timeBegin("step");
+            profiler.timeEnd("step");
+        }
+        usleep(300000);
+        profiler.stop();
+
+        std::istringstream content(memorySink->content());
+        std::string line;
+        int nbDumps = 0;
+        double apiTime = 0., writeTime = 0., events = 0., bytes = 0.;
+        while (std::getline(content, line)) {
+            if (line.rfind("uprofile_self;", 0) != 0) {
+                continue;
+            }
+            // Format is 'uprofile_self;timestamp;cpu_ms;api_us;write_us;events;bytes;lock_wait_us;dropped;filtered'
+            std::vector<std::string> fields;
+            std::istringstream record(line);
+            std::string field;
+            while (std::getline(record, field, ';')) {
+                fields.push_back(field);
+            }
+            REQUIRE(fields.size() == 10);
+            apiTime += std::stod(fields[3]);
+            writeTime += std::stod(fields[4]);
+            events += std::stod(fields[5]);
+            bytes += std::stod(fields[6]);
+            REQUIRE(std::stod(fields[8]) == 0.);
+            nbDumps++;
+        }
+        REQUIRE(nbDumps > 0);
+        REQUIRE(apiTime > 0.);
+        REQUIRE(writeTime > 0.);
+        REQUIRE(writeTime < apiTime);
+        REQUIRE(events >= 1000.);
+        REQUIRE(bytes > events * 10.);
+    }
+
+    SECTION("Producers contending")
+    {
+        std::atomic<bool> lockWaited(false);
+        profiler.addSink(new uprofile::CallbackSink([&lockWaited](const char* records, size_t size, size_t) {
+            // lock_wait_us is the 8th field of the 'uprofile_self' records
+            std::istringstream content(std::string(records, size));
+            std::string line;
+            while (std::getline(content, line)) {
+                std::vector<std::string> fields;
+                std::istringstream record(line);
+                std::string field;
+                while (std::getline(record, field, ';')) {
+                    fields.push_back(field);
+                }
+                if (fields.size() == 10 && std::stod(fields[7]) > 0.) {
+                    lockWaited = true;
+                }
+            }
+        }), {"uprofile_self"});
+
+        // Threads writing events at full speed until one of them waits for another
+        std::atomic<bool> running(true);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&]() {
+                while (running) {
+                    profiler.timeEnd("contention");
+                }
+            });
+        }
+        for (int i = 0; i < 100 && !lockWaited; ++i) {
+            usleep(50000);
+        }
+        running = false;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        profiler.stop();
+        REQUIRE(lockWaited);
+    }
+}